@@ -22,29 +22,94 @@
 * Includes
 *******************************************************************************/
 #include "TTDelay.h"
+#if TT_SCAN_MASK
+    #if defined(__AVX2__) || defined(__SSE2__)
+        #include <immintrin.h>
+    #endif
+    #include <string.h>
+#endif
 
 /*******************************************************************************
 * Defines
-********************************************************************************
+*******************************************************************************/
+// scheduling fields of a task, see TT_TASK_LAYOUT
+#if TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    #define TT_HOT(tt, index, field)    ((tt)->hot.field[index])
+#else
+    #define TT_HOT(tt, index, field)    ((tt)->task[index].field)
+#endif
+// fields that do not change after the task is created, in ROM with TT_STATIC_TASKS
+#ifdef TT_STATIC_TASKS
+    #define TT_CONST(tt, index, field)  (ttStaticTask[index].field)
+#else
+    #define TT_CONST(tt, index, field)  ((tt)->task[index].field)
+#endif
+
+#if TT_SCAN_MASK && ((TT_TASK_LAYOUT != TT_LAYOUT_SPLIT) || (TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR))
+    #error "TT_SCAN_MASK needs TT_TASK_LAYOUT TT_LAYOUT_SPLIT and TT_SCHEDULER_ENGINE TT_ENGINE_LINEAR"
+#endif
+#if TT_READY_BITMAP && (TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR)
+    #error "TT_READY_BITMAP needs TT_SCHEDULER_ENGINE TT_ENGINE_HEAP or TT_ENGINE_WHEEL"
+#endif
+#if TT_READY_BITMAP && (TT_SCHEDULING_POLICY == TT_POLICY_EDF)
+    #error "TT_READY_BITMAP keeps the due tasks by priority, it can not be used with TT_POLICY_EDF"
+#endif
+#if defined(TT_STATIC_TASKS) && TT_READY_BITMAP
+    #error "TT_STATIC_TASKS starts with all tasks due, TT_READY_BITMAP is not set up for that"
+#endif
+#ifdef TT_STATIC_TASKS
+_Static_assert(TT_STATIC_TASK_COUNT <= TT_TASK_COUNT_MAX, "more TT_STATIC_TASKS than TT_TASK_COUNT_MAX");
+#endif
+#if TT_TRACE && (TT_TRACE_SIZE & (TT_TRACE_SIZE - 1))
+    #error "TT_TRACE_SIZE has to be a power of two"
+#endif
+
+// trace_count is written after the event, a reader on another core sees the
+// event complete once it sees the new count
+#ifdef __GNUC__
+    #define TT_TRACE_PUBLISH(x, v)      __atomic_store_n(&(x), (v), __ATOMIC_RELEASE)
+    #define TT_TRACE_COUNT(x)           __atomic_load_n(&(x), __ATOMIC_ACQUIRE)
+#else
+    #define TT_TRACE_PUBLISH(x, v)      ((x) = (v))
+    #define TT_TRACE_COUNT(x)           (x)
+#endif
+
+// index of the highest set bit (floor of log2), x must not be 0
+#ifdef __GNUC__
+    #define TT_LOG2(x)                  ((uint8_t)(63 - __builtin_clzll((unsigned long long)(x))))
+#else
+    static uint8_t TT_LOG2(uint64_t x) { uint8_t n = 0; while (x >>= 1) n++; return n; }
+#endif
+
+#define TT_HISTOGRAM_SUB                (1 << TT_HISTOGRAM_SUB_BITS)
+
+// a due task can not starve with deadlines, aging would only reorder ties
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    #undef  TT_ENABLE_TASK_AGING
+    #define TT_ENABLE_TASK_AGING        0
+#endif
+
+// true if due task i goes before the one picked so far by TTDelay_find_due_tasks_r()
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    #define TT_DUE_FIRST(tt, i)         TTDelay_due_before(tt, i, (tt)->highest_priority_index)
+#else
+    #define TT_DUE_FIRST(tt, i)         ((TT_HOT(tt, i, uiCurrentPriority) < (tt)->highest_priority_value) \
+                                        || ((TT_HOT(tt, i, uiCurrentPriority) == (tt)->highest_priority_value) \
+                                            && ((i) < (tt)->highest_priority_index)))
+#endif
+
+// index of the lowest set bit, x must not be 0
+#ifdef __GNUC__
+    #define TT_CTZ32(x)                 ((uint8_t)__builtin_ctz(x))
+#else
+    static uint8_t TT_CTZ32(uint32_t x) { uint8_t n = 0; while (!(x & 1)) { x >>= 1; n++; } return n; }
+#endif
 
 
 /*******************************************************************************
 * Local Types and Typedefs
 *******************************************************************************/
-typedef struct {
-    uint8_t         current_task_index;
-    uint8_t         task_count;
-    uint8_t         highest_priority_value;
-    uint8_t         highest_priority_index;
-    uint8_t         task_scheduled_count;
-    TT_TIMER_TYPE   current_time;
-    TT_TIMER_TYPE   last_run_time;
-    TT_TIMER_TYPE   uiCpuTtsysCycleTickCount;
-    TT_TIMER_TYPE   uiCpuIdleCycleTickCount;
-    float           rIdleTimePercentage;
-    float           rTtsysTimePercentage;
-    TTDelay_task_t  task [ TT_TASK_COUNT_MAX ];
-}TTDelay_t; 
+
 
 /*******************************************************************************
 * Global Variables
@@ -54,61 +119,264 @@ typedef struct {
 /*******************************************************************************
 * Static Function Prototypes
 *******************************************************************************/
-void TTDelay_find_due_tasks(void);
-void TTDelay_adjust_priority(void);
-void TTDelay_run_task(int index);
-void TTDelay_time_measure(TT_TIMER_TYPE* puiAddTimeToValue);
-void TTDelay_reset_time_running(void);
-void TTDelay_calculate_cpu_usage(void);
+TT_TIMER_TYPE TTDelay_time_measure(TTDelay_t* tt, TT_CPU_TICK_TYPE* puiAddTimeToValue);
+void TTDelay_idle_measure(TTDelay_t* tt);
 extern TT_TIMER_TYPE GET_RST_TICK;
+static void TTDelay_engine_insert(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_engine_remove(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_engine_update(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static TT_TASK_INDEX_TYPE TTDelay_engine_earliest(TTDelay_t* tt);
+static void TTDelay_task_attach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_task_detach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_task_put_back(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_task_free(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_cpu_usage_update(TTDelay_t* tt, TTDelay_task_t* task);
+static int TTDelay_due_before(TTDelay_t* tt, TT_TASK_INDEX_TYPE a, TT_TASK_INDEX_TYPE b);
+#if TT_TASK_EVENTS
+static void TTDelay_take_events(TTDelay_t* tt);
+#endif
+#if TT_TASK_COMMANDS
+static void TTDelay_take_commands(TTDelay_t* tt);
+static void TTDelay_release_commands(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+#endif
+#if TT_SCHEDULE_TABLE
+static int  TTDelay_slot_before(TTDelay_t* tt, const TTDelay_slot_t* a, const TTDelay_slot_t* b);
+static void TTDelay_table_dispatch(TTDelay_t* tt, TT_TASK_INDEX_TYPE index, TT_TIMER_TYPE uiTime);
+#endif
+#if TT_ADMISSION_CONTROL && !defined(TT_STATIC_TASKS)
+static int TTDelay_admit(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+#endif
+#if TT_EXEC_HISTOGRAM || TT_LATENESS_STATS
+static void TTDelay_histogram_add(TTDelay_histogram_t* histogram, TT_TIMER_TYPE uiTime);
+static TT_TIMER_TYPE TTDelay_histogram_percentile(TTDelay_histogram_t* histogram, uint16_t uiPermille);
+#endif
+#if TT_EXEC_HISTOGRAM
+static void TTDelay_histogram_clear(TTDelay_histogram_t* histogram);
+#endif
+#if TT_LATENESS_STATS
+static void TTDelay_lateness_add(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_lateness_clear(TTDelay_lateness_t* lateness);
+#endif
+#if TT_READY_BITMAP
+static void TTDelay_level_push(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_level_unlink(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static uint16_t TTDelay_level_used(TTDelay_t* tt, uint16_t from);
+static void TTDelay_level_splice(TTDelay_t* tt, uint8_t level);
+#endif
 
 /*******************************************************************************
 * Static Variables
 *******************************************************************************/
-// this holds our complete system. initialize everything to 0.
+#ifdef TT_STATIC_TASKS
+// the state TTDelay_reset_r() sets up, built by the compiler: all tasks due
+#if (TT_TASK_LAYOUT != TT_LAYOUT_SPLIT) && (TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR)
+#define TT_STATIC_TASK_STATE(name, func, in, out, priority, period) \
+    { .uiFlags = (period) ? TT_TASK_IS_PERIODIC : 0, .uiDeadline = (period), .uiCurrentPriority = (priority), .fDue = 1 },
+#else
+#define TT_STATIC_TASK_STATE(name, func, in, out, priority, period) \
+    { .uiFlags = (period) ? TT_TASK_IS_PERIODIC : 0, .uiDeadline = (period), .uiCurrentPriority = (priority) },
+#endif
+#define TT_STATIC_TASK_PRIORITY(name, func, in, out, priority, period)  (priority),
+#define TT_STATIC_TASK_DUE(name, func, in, out, priority, period)       1,
+
+// the default instance used by all functions without _r, ready to run
+TTDelay_t                   ttSystem    = {
+    .task_count     = TT_STATIC_TASK_COUNT,
+    .task           = { TT_STATIC_TASKS(TT_STATIC_TASK_STATE) },
+#if TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    .hot            = { .uiCurrentPriority = { TT_STATIC_TASKS(TT_STATIC_TASK_PRIORITY) },
+#if TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR
+                        .fDue              = { TT_STATIC_TASKS(TT_STATIC_TASK_DUE) },
+#endif
+                      },
+#endif
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+    .active_count   = TT_STATIC_TASK_COUNT,
+    .active         = { TT_STATIC_TASKS(TT_STATIC_TASK_INDEX) },
+#else
+    .ready_count    = TT_STATIC_TASK_COUNT,
+    .ready          = { TT_STATIC_TASKS(TT_STATIC_TASK_INDEX) },
+    .position       = { TT_STATIC_TASKS(TT_STATIC_TASK_INDEX) },
+#endif
+};
+#else
+// the default instance used by all functions without _r. initialize everything to 0.
 TTDelay_t                   ttSystem    = {0};
-TTDelay_cpu_usage_TypDef    ttCpuLoad   = {0};
+#endif
+// the instance that runs the current task (one per thread if TT_THREAD_LOCAL is set).
+// TTDelay_from_now() and friends act on this one, as task functions get no handle.
+static TT_THREAD_LOCAL TTDelay_t* ttCurrent = &ttSystem;
+static TT_THREAD_LOCAL TT_TASK_INDEX_TYPE ttCurrentTask;
 
 /*******************************************************************************
 * F U N C T I O N S   U S E D   I N   U S E R   P R O G R A M
 *******************************************************************************/
-/* removes all the tasks */
-void TTDelay_reset(void) {
-    uint8_t *data = (uint8_t*)&ttSystem;
+/* removes all the tasks. with TT_STATIC_TASKS the tasks of the table are set
+ * up again, all due. */
+void TTDelay_reset_r(TTDelay_t* tt) {
+    uint8_t *data = (uint8_t*)tt;
     for (int i = 0; i < sizeof(TTDelay_t) ; i++,data++){
         *data = 0;
     }
+#ifdef TT_STATIC_TASKS
+    for (TT_TASK_INDEX_TYPE index = 0 ; index < TT_STATIC_TASK_COUNT ; index++){
+        tt->task[index].uiFlags    = ttStaticTask[index].uiPeriod ? TT_TASK_IS_PERIODIC : 0;
+        tt->task[index].uiDeadline = ttStaticTask[index].uiPeriod;
+        TT_HOT(tt, index, uiCurrentPriority) = ttStaticTask[index].uiInitialPriority;
+        tt->task_count++;
+        TTDelay_task_attach(tt, index);
+    }
+#endif
 }
 
-/* Create a task for the TTDelay System. */
-int TTDelay_create_task(void (*func ), void* input_param, void* output_param, uint8_t priority){
-    if (ttSystem.task_count >= TT_TASK_COUNT_MAX)
+#ifndef TT_STATIC_TASKS
+/* Create a task for the TTDelay System. The index of the new task is returned
+ * by TTDelay_get_last_created_r(tt), it stays the same until the task is deleted.
+ * The slots of deleted tasks are used first. */
+int TTDelay_create_task_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority){
+    TT_TASK_INDEX_TYPE index;
+    if (tt->free_count)
+        index = tt->free_slot[--tt->free_count];
+    else if (tt->task_count < TT_TASK_COUNT_MAX)
+        index = tt->task_count++;
+    else
         return TT_ERROR_TOO_MANY_TASKS;
 
-    TTDelay_task_t *task        = &ttSystem.task[ttSystem.task_count];
+    TTDelay_task_t *task        = &tt->task[index];
+    // a reused slot still holds the data of the deleted task
+    *task                       = (TTDelay_task_t){0};
+#if TT_EXEC_HISTOGRAM
+    TTDelay_histogram_clear(&tt->histogram[index]);
+#endif
+#if TT_LATENESS_STATS
+    TTDelay_lateness_clear(&tt->lateness[index]);
+#endif
+#if TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    TT_HOT(tt, index, uiNextExecuteOverflow) = 0;
+    TT_HOT(tt, index, fDue)                  = 0;
+    TT_HOT(tt, index, fRunning)              = 0;
+#endif
     task->func                  = func;
     task->uiFlags               = 0;
-    task->uiCurrentPriority     = priority;
+    TT_HOT(tt, index, uiCurrentPriority)     = priority;
     task->uiInitialPriority     = priority;
     task->pvFuncParameterOut    = output_param;
     task->pvFuncParameterIn     = input_param;
-    task->uiTimeNextExecute     = TT_TIMER_FUNC;
+    TT_HOT(tt, index, uiTimeNextExecute)     = TT_TIMER_FUNC;
     
-    ttSystem.task_count++;
+    tt->last_created_index      = index;
+    TTDelay_task_attach(tt, index);
+    return TT_OK;
+}
+
+// creates a periodic task and checks the task set with it (TT_ADMISSION_CONTROL)
+static int TTDelay_create_periodic(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiDeadline, TT_TIMER_TYPE uiWcet){
+    int error;
+    error = TTDelay_create_task_r(tt, func, input_param, output_param, priority);
+    if (error)
+        return error;
+    TTDelay_task_t* task        = &tt->task[tt->last_created_index];
+    task->uiPeriod              = uiPeriod;
+    task->uiDeadline            = uiDeadline;
+    task->uiFlags              |= TT_TASK_IS_PERIODIC;
+#if TT_ADMISSION_CONTROL
+    task->uiWcet                = uiWcet;
+    return TTDelay_admit(tt, tt->last_created_index);
+#else
     return TT_OK;
+#endif
 }
 
 /* same as TTDelay_create_task, but takes an additional uiPeriod argument and sets an additional flag */
-int TTDelay_create_task_periodic(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod){
+int TTDelay_create_task_periodic_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod){
+    return TTDelay_create_periodic(tt, func, input_param, output_param, priority, uiPeriod, uiPeriod, 0);
+}
+
+/* create a task with a deadline uiDeadline ticks after its next execute time,
+ * used by TT_POLICY_EDF. uiPeriod 0 creates a task that is not periodic. */
+int TTDelay_create_task_deadline_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiDeadline){
     int error;
-    error = TTDelay_create_task(func, input_param, output_param, priority);
+    if (uiPeriod)
+        return TTDelay_create_periodic(tt, func, input_param, output_param, priority, uiPeriod, uiDeadline, 0);
+    error = TTDelay_create_task_r(tt, func, input_param, output_param, priority);
     if (error)
         return error;
-    ttSystem.task[ttSystem.task_count-1].uiPeriod = uiPeriod;
-    ttSystem.task[ttSystem.task_count-1].uiFlags |= TT_TASK_IS_PERIODIC;
+    tt->task[tt->last_created_index].uiDeadline = uiDeadline;
+    return TT_OK;
+}
+
+#if TT_ADMISSION_CONTROL
+/* create a periodic task with a declared worst case execution time uiWcet
+ * (TT_READ_RST_TICK_FUNC ticks) for the schedulability check. returns
+ * TT_ERROR_NOT_SCHEDULABLE if the check fails with TT_ADMISSION_REJECT. */
+int TTDelay_create_task_wcet_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiWcet){
+    return TTDelay_create_periodic(tt, func, input_param, output_param, priority, uiPeriod, uiPeriod, uiWcet);
+}
+#endif
+#endif
+
+static int TTDelay_task_exists(TTDelay_t* tt, int index){
+    return (index >= 0) && (index < tt->task_count)
+        && !(tt->task[index].uiFlags & TT_TASK_DELETED);
+}
+
+/* remove a task, its index may be given to a task created later on. A task can
+ * delete itself (see TTDelay_get_current_task()), it is removed once it returns.
+ * A running task only gets the flag, TTDelay_task_end_r() takes it out on the
+ * thread that owns the instance. So a task run by TTDelay_pool.c may delete
+ * itself, other tasks are changed with TTDelay_post_command_r() from there. */
+int TTDelay_delete_task_r(TTDelay_t* tt, int index){
+    if (!TTDelay_task_exists(tt, index))
+        return TT_NOK;
+    if (TT_HOT(tt, index, fRunning)){
+        tt->task[index].uiFlags |= TT_TASK_DELETED;
+        return TT_OK;
+    }
+    if (!(tt->task[index].uiFlags & TT_TASK_SUSPENDED))
+        TTDelay_task_detach(tt, index);
+    TTDelay_task_free(tt, index);
+    return TT_OK;
+}
+
+/* a suspended task is not run and not looked at until it is resumed. like
+ * TTDelay_delete_task_r(), a running task is taken out once it returns. */
+int TTDelay_suspend_task_r(TTDelay_t* tt, int index){
+    if (!TTDelay_task_exists(tt, index))
+        return TT_NOK;
+    if (tt->task[index].uiFlags & TT_TASK_SUSPENDED){
+        // no longer woken up by events
+        tt->task[index].uiFlags &= ~TT_TASK_WAIT_EVENT;
+        return TT_OK;
+    }
+    if (!TT_HOT(tt, index, fRunning))
+        TTDelay_task_detach(tt, index);
+    tt->task[index].uiFlags |= TT_TASK_SUSPENDED;
+    return TT_OK;
+}
+
+/* a resumed task is due right away. A task that suspended itself and is
+ * resumed before it returns keeps the next execute time it set. */
+int TTDelay_resume_task_r(TTDelay_t* tt, int index){
+    TTDelay_task_t* task;
+    if (!TTDelay_task_exists(tt, index))
+        return TT_NOK;
+    task = &tt->task[index];
+    if (!(task->uiFlags & TT_TASK_SUSPENDED))
+        return TT_OK;
+    task->uiFlags &= ~(TT_TASK_SUSPENDED | TT_TASK_WAIT_EVENT);
+    // a running task was never taken out
+    if (TT_HOT(tt, index, fRunning))
+        return TT_OK;
+    TT_HOT(tt, index, uiTimeNextExecute)     = TT_TIMER_FUNC;
+    TT_HOT(tt, index, uiNextExecuteOverflow) = 0;
+    TTDelay_task_attach(tt, index);
     return TT_OK;
 }
 
+int TTDelay_get_last_created_r(TTDelay_t* tt){
+    return tt->last_created_index;
+}
+
 /* this is the core function of the system that will be called in the users
  * main program loop and execute the tasks.
  * - measure time passed since last call (idle time for TTDelay System) 
@@ -116,15 +384,15 @@ int TTDelay_create_task_periodic(void (*func ), void* input_param, void* output_
  * - if tasks are due: add aging to scheduled tasks that will not be run this time
  * - if tasks are due: run highest priority scheduled (includes time measurement) 
  * - returns TT_OK if all is done and TT_MORE_TASKS_SCHEDULED if more tasks are due */
-int TTDelay_run(void) {
-    TTDelay_time_measure(&ttSystem.uiCpuIdleCycleTickCount);
-    TTDelay_find_due_tasks();
-    if(ttSystem.task_scheduled_count){
+int TTDelay_run_r(TTDelay_t* tt) {
+    TTDelay_idle_measure(tt);
+    TTDelay_find_due_tasks_r(tt);
+    if(tt->task_scheduled_count){
         #if TT_ENABLE_TASK_AGING
-        TTDelay_adjust_priority();
+        TTDelay_adjust_priority_r(tt);
         #endif
-        TTDelay_run_task(ttSystem.highest_priority_index);
-        if (ttSystem.task_scheduled_count > 1)
+        TTDelay_run_task_r(tt, tt->highest_priority_index);
+        if (tt->task_scheduled_count > 1)
             return TT_MORE_TASKS_SCHEDULED;
     }
     return TT_OK;
@@ -135,235 +403,2162 @@ int TTDelay_run(void) {
  * a function that always uses TTDelay_from_last(100) (here: 100 ms) will be 
  * called 10 times a second  */
 void TTDelay_from_last(int delay){
+    TTDelay_t*      tt = ttCurrent;
     TTDelay_task_t* task;
-    task = &ttSystem.task[ttSystem.current_task_index];
+    task = &tt->task[ttCurrentTask];
 
-    if (task->uiTimeNextExecute + delay < task->uiTimeNextExecute){
-        task->uiNextExecuteOverflow = 1;
+    if (TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) + delay < TT_HOT(tt, ttCurrentTask, uiTimeNextExecute)){
+        TT_HOT(tt, ttCurrentTask, uiNextExecuteOverflow) = 1;
     }
-    task->uiTimeNextExecute += delay;
+    TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) += delay;
     if (!(task->uiFlags & TT_TASK_EVER_RUN)){
         task->uiFlags |= TT_TASK_EVER_RUN;
         if (task->uiFlags & TT_TASK_IS_PERIODIC )
-            if (task->uiTimeNextExecute < ttSystem.current_time)
-                task->uiTimeNextExecute = ttSystem.current_time + task->uiPeriod;
+            if (TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) < task->uiTimeLastExecute)
+                TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) = task->uiTimeLastExecute + TT_CONST(tt, ttCurrentTask, uiPeriod);
     }
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_FROM_LAST, ttCurrentTask, TT_HOT(tt, ttCurrentTask, uiTimeNextExecute));
+#endif
+    TTDelay_engine_update(tt, ttCurrentTask);
 }
 
 /* call this function again in 'delay' timer ticks. This may be used if the next
  * function/task call needs a certain time span AFTER the current task/function call */
 void TTDelay_from_now (int delay){
+    TTDelay_t*      tt = ttCurrent;
     TTDelay_task_t* task;
-    task = &ttSystem.task[ttSystem.current_task_index];
-    task->uiTimeNextExecute = ttSystem.current_time + delay;
-    if (task->uiTimeNextExecute < task->uiTimeLastExecute)
-        task->uiNextExecuteOverflow = 1;
+    task = &tt->task[ttCurrentTask];
+    // uiTimeLastExecute is the time the current run was started
+    TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) = task->uiTimeLastExecute + delay;
+    if (TT_HOT(tt, ttCurrentTask, uiTimeNextExecute) < task->uiTimeLastExecute)
+        TT_HOT(tt, ttCurrentTask, uiNextExecuteOverflow) = 1;
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_FROM_NOW, ttCurrentTask, TT_HOT(tt, ttCurrentTask, uiTimeNextExecute));
+#endif
+    TTDelay_engine_update(tt, ttCurrentTask);
 }
 
-// estimates the CPU usage per task
+// estimates the CPU usage per task. the update reads and clears the times of
+// all tasks, it is done once the monitor returns (see TTDelay_cpu_usage_update)
 void TTDelay_cpu_usage_monitor(void* in, void* out){
-    TTDelay_calculate_cpu_usage();
-    TTDelay_reset_time_running();
+    ttCurrent->task[ttCurrentTask].uiFlags |= TT_TASK_CPU_UPDATE;
     TTDelay_from_last(TT_CPU_LOAD_UPDATE_INTERVAL);
 }
 
 
+#ifndef TT_STATIC_TASKS
 /* the user may change the function that will be executed on the next task run */
 int TTDelay_set_next_function(void (*func )){
     if (func == (void*)0)
         return TT_NOK;
-    ttSystem.task[ttSystem.current_task_index].func = func;
+    ttCurrent->task[ttCurrentTask].func = func;
+    // a coroutine starts at its beginning
+    ttCurrent->task[ttCurrentTask].uiResumePoint = 0;
+#if TT_TRACE
+    TTDelay_trace_r(ttCurrent, TT_TRACE_SET_FUNCTION, ttCurrentTask, (uint32_t)(uintptr_t)func);
+#endif
     return TT_OK;    
 }
+#endif
+
+#if TT_TASK_EVENTS
+/* make a task due right away. safe to call from interrupts and other threads:
+ * it only sets the pending bit of the task, the next TTDelay_find_due_tasks_r()
+ * takes it. a task suspended by TTDelay_suspend_task_r() ignores events.
+ * TT_NOK if index is out of range. */
+int TTDelay_notify_r(TTDelay_t* tt, int index){
+    if ((index < 0) || (index >= TT_TASK_COUNT_MAX))
+        return TT_NOK;
+    TT_ATOMIC_OR(&tt->event_pending[index / 32], (uint32_t)1 << (index % 32));
+    TT_ATOMIC_OR(&tt->event_summary, (uint32_t)1 << ((index / 32) % 32));
+    if (tt->wake_hook)
+        tt->wake_hook(tt->wake_context);
+    return TT_OK;
+}
+
+/* run the current task again when it is notified or 'timeout' ticks after the
+ * start of the current run, whatever comes first. TT_WAIT_FOREVER: only when
+ * notified, the task is suspended until then. */
+void TTDelay_wait_event(int timeout){
+    TTDelay_t* tt = ttCurrent;
+    if (timeout == TT_WAIT_FOREVER){
+        TTDelay_suspend_task_r(tt, ttCurrentTask);
+        tt->task[ttCurrentTask].uiFlags |= TT_TASK_WAIT_EVENT;
+    }
+    else
+        TTDelay_from_now(timeout);
+}
+
+/* 1 if the current run of the task was started by TTDelay_notify_r() */
+int TTDelay_was_notified(void){
+    return (ttCurrent->task[ttCurrentTask].uiFlags & TT_TASK_NOTIFIED) != 0;
+}
+#endif
+
+#if TT_TASK_COMMANDS
+/* change task 'index' from any thread or interrupt, uiType is one of
+ * TT_COMMAND_... . the command is queued without locks (bounded MPSC queue,
+ * a CAS on the tail claims a slot) and applied by the next
+ * TTDelay_find_due_tasks_r(tt), in the order posted. TT_NOK if the queue is full. */
+int TTDelay_post_command_r(TTDelay_t* tt, int index, uint8_t uiType, TT_TIMER_TYPE uiValue){
+    uint32_t           pos = TT_ATOMIC_LOAD(&tt->command_tail);
+    TTDelay_command_t* slot;
+
+    if ((index < 0) || (index >= TT_TASK_COUNT_MAX))
+        return TT_NOK;
+#ifdef TT_STATIC_TASKS
+    // period and priority are in ROM
+    if ((uiType == TT_COMMAND_PERIOD) || (uiType == TT_COMMAND_PRIORITY))
+        return TT_NOK;
+#endif
+    while (1){
+        slot = &tt->command[pos % TT_COMMAND_QUEUE_SIZE];
+        int32_t diff = (int32_t)(TT_ATOMIC_LOAD(&slot->uiSequence) + pos % TT_COMMAND_QUEUE_SIZE - pos);
+        if (diff == 0){
+            // free for this position, claim it. on failure pos is the new tail
+            if (TT_ATOMIC_CAS(&tt->command_tail, &pos, pos + 1))
+                break;
+        }
+        else if (diff < 0)
+            return TT_NOK;              // the command a lap ago is not applied yet
+        else
+            pos = TT_ATOMIC_LOAD(&tt->command_tail);
+    }
+    slot->uiTask  = (TT_TASK_INDEX_TYPE)index;
+    slot->uiType  = uiType;
+    slot->uiValue = uiValue;
+    // hand the slot to TTDelay_take_commands()
+    TT_ATOMIC_STORE(&slot->uiSequence, pos + 1 - pos % TT_COMMAND_QUEUE_SIZE);
+    if (tt->wake_hook)
+        tt->wake_hook(tt->wake_context);
+    return TT_OK;
+}
+#endif
+
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+/* fn(context) is called after every TTDelay_notify_r() and
+ * TTDelay_post_command_r(), e.g. to end the sleep of TTDelay_sleep_run()
+ * (TTDelay_sleep_init() sets it). it runs on the caller, which may be an
+ * interrupt. set it before anybody notifies or posts and after
+ * TTDelay_reset_r(tt), fn NULL removes it. */
+void TTDelay_set_wake_hook_r(TTDelay_t* tt, void (*fn)(void* context), void* context){
+    tt->wake_context = context;
+    tt->wake_hook    = fn;
+}
+#endif
+
+#if TT_SCHEDULE_TABLE
+/* compute the schedule table of all periodic tasks that are not suspended:
+ * every start within the hyperperiod (least common multiple of the periods),
+ * ordered by offset, then priority, then task index. the offsets keep the
+ * phases of the next execute times. may be run offline (simulation/tt_table)
+ * or once at startup. returns the number of slots, -1 if the hyperperiod does
+ * not fit into TT_TIMER_TYPE or there are more than iMaxSlots. */
+int TTDelay_table_generate_r(TTDelay_t* tt, TTDelay_slot_t* slot, int iMaxSlots, TT_TIMER_TYPE* puiHyperperiod){
+    uint64_t      hyperperiod = 1;
+    TT_TIMER_TYPE base        = TT_IDLE_FOREVER;
+    int           count       = 0;
+
+    for (TT_TASK_INDEX_TYPE i = 0 ; i < tt->task_count ; i++){
+        TTDelay_task_t* task = &tt->task[i];
+        uint64_t a = hyperperiod, b = TT_CONST(tt, i, uiPeriod);
+        if (!TTDelay_task_exists(tt, i) || (task->uiFlags & TT_TASK_SUSPENDED)
+            || !(task->uiFlags & TT_TASK_IS_PERIODIC) || !b)
+            continue;
+        while (b){
+            uint64_t r = a % b;
+            a = b;
+            b = r;
+        }
+        hyperperiod = hyperperiod / a * TT_CONST(tt, i, uiPeriod);
+        // half the range is left for starts that are late
+        if (hyperperiod > TT_IDLE_FOREVER / 2)
+            return -1;
+        if (TT_HOT(tt, i, uiTimeNextExecute) < base)
+            base = TT_HOT(tt, i, uiTimeNextExecute);
+    }
+
+    for (TT_TASK_INDEX_TYPE i = 0 ; i < tt->task_count ; i++){
+        TTDelay_task_t* task   = &tt->task[i];
+        TT_TIMER_TYPE   period = TT_CONST(tt, i, uiPeriod);
+        if (!TTDelay_task_exists(tt, i) || (task->uiFlags & TT_TASK_SUSPENDED)
+            || !(task->uiFlags & TT_TASK_IS_PERIODIC) || !period)
+            continue;
+        if (count + hyperperiod / period > (uint64_t)iMaxSlots)
+            return -1;
+        for (uint64_t offset = (TT_HOT(tt, i, uiTimeNextExecute) - base) % period ;
+             offset < hyperperiod ; offset += period){
+            // insertion sort, the table is built once
+            int pos = count++;
+            TTDelay_slot_t entry = { (TT_TIMER_TYPE)offset, i };
+            while (pos && TTDelay_slot_before(tt, &entry, &slot[pos - 1])){
+                slot[pos] = slot[pos - 1];
+                pos--;
+            }
+            slot[pos] = entry;
+        }
+    }
+    *puiHyperperiod = (TT_TIMER_TYPE)hyperperiod;
+    return count;
+}
+
+/* run the iCount slots (from TTDelay_table_generate_r, may be a const table)
+ * with TTDelay_run_table_r(tt, table), the hyperperiod starts now */
+int TTDelay_table_start_r(TTDelay_t* tt, TTDelay_table_t* table, const TTDelay_slot_t* slot, int iCount, TT_TIMER_TYPE uiHyperperiod){
+    if ((iCount < 1) || !uiHyperperiod || (slot[iCount - 1].uiOffset >= uiHyperperiod))
+        return TT_NOK;
+    table->slot          = slot;
+    table->uiCount       = (uint32_t)iCount;
+    table->uiNext        = 0;
+    table->uiHyperperiod = uiHyperperiod;
+    table->uiStart       = TT_TIMER_FUNC;
+    return TT_OK;
+}
+
+/* time triggered replacement for TTDelay_run_r(tt): runs the next slot of the
+ * table if its offset is reached. there is no search, no aging and no
+ * rescheduling, only the next slot is looked at. a slot that is late is run
+ * late, none is skipped. returns TT_MORE_TASKS_SCHEDULED if the following slot
+ * is due as well. suspended and deleted tasks are left out, the next execute
+ * times of the tasks are not used. */
+int TTDelay_run_table_r(TTDelay_t* tt, TTDelay_table_t* table){
+    TT_TIMER_TYPE         elapsed = TT_TIMER_FUNC - table->uiStart;
+    const TTDelay_slot_t* slot;
+
+    if (table->uiNext == table->uiCount){
+        // all slots of this hyperperiod were run, wait for the next one
+        if (elapsed < table->uiHyperperiod)
+            return TT_OK;
+        table->uiStart += table->uiHyperperiod;
+        elapsed        -= table->uiHyperperiod;
+        table->uiNext   = 0;
+    }
+    slot = &table->slot[table->uiNext];
+    if (elapsed < slot->uiOffset)
+        return TT_OK;
+    table->uiNext++;
+    TTDelay_table_dispatch(tt, slot->uiTask, table->uiStart + slot->uiOffset);
+    if ((table->uiNext < table->uiCount) && (elapsed >= table->slot[table->uiNext].uiOffset))
+        return TT_MORE_TASKS_SCHEDULED;
+    return TT_OK;
+}
+#endif
 
 
 /*******************************************************************************
 * I N T E R N A L   F U N C T I O N S
 *******************************************************************************/
 /* Calls a user function that reads the current timer value AND RESETS the timer */
-void TTDelay_time_measure(TT_TIMER_TYPE* puiAddTimeToValue){
-    int duration = 0;
+TT_TIMER_TYPE TTDelay_time_measure(TTDelay_t* tt, TT_CPU_TICK_TYPE* puiAddTimeToValue){
+    TT_TIMER_TYPE duration = 0;
     GET_RST_TICK(duration);
     *puiAddTimeToValue += duration;
-    return;
+#if TT_TRACE
+    // every tick is counted once, so the sum is a clock for the trace events
+    tt->trace_ticks += duration;
+#endif
+    return duration;
+}
+
+/* the time since the end of the last task run or TTDelay_run_r() is idle time */
+void TTDelay_idle_measure(TTDelay_t* tt){
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_IDLE, TT_TRACE_NO_TASK, TTDelay_time_measure(tt, &tt->uiCpuIdleCycleTickCount));
+#else
+    TTDelay_time_measure(tt, &tt->uiCpuIdleCycleTickCount);
+#endif
+}
+
+#if TT_TASK_EVENTS
+/* make the notified tasks due. only the pending words flagged in the summary
+ * are looked at and only their set bits. a running task (worker pool) keeps
+ * its event until it ended. */
+static void TTDelay_take_events(TTDelay_t* tt) {
+    uint32_t summary = TT_ATOMIC_TAKE(&tt->event_summary);
+    while (summary){
+        uint8_t bit = TT_CTZ32(summary);
+        summary &= summary - 1;
+        for (uint16_t w = bit ; w < (TT_TASK_COUNT_MAX + 31) / 32 ; w += 32){
+            uint32_t events = tt->event_pending[w] ? TT_ATOMIC_TAKE(&tt->event_pending[w]) : 0;
+            while (events){
+                TT_TASK_INDEX_TYPE index = (TT_TASK_INDEX_TYPE)(w * 32 + TT_CTZ32(events));
+                TTDelay_task_t*    task  = &tt->task[index];
+                events &= events - 1;
+                if (!TTDelay_task_exists(tt, index))
+                    continue;
+                if (TT_HOT(tt, index, fRunning)){
+                    TTDelay_notify_r(tt, index);
+                    continue;
+                }
+                if ((task->uiFlags & TT_TASK_SUSPENDED) && !(task->uiFlags & TT_TASK_WAIT_EVENT))
+                    continue;
+                task->uiFlags |= TT_TASK_NOTIFIED;
+                TT_HOT(tt, index, uiTimeNextExecute)     = tt->current_time;
+                TT_HOT(tt, index, uiNextExecuteOverflow) = 0;
+                if (task->uiFlags & TT_TASK_SUSPENDED){
+                    task->uiFlags &= ~(TT_TASK_SUSPENDED | TT_TASK_WAIT_EVENT);
+                    TTDelay_task_attach(tt, index);
+                }
+                else
+                    TTDelay_engine_update(tt, index);
+            }
+        }
+    }
+}
+#endif
+
+#if TT_TASK_COMMANDS
+// one command of the queue, see TTDelay_post_command_r()
+static void TTDelay_execute_command(TTDelay_t* tt, TT_TASK_INDEX_TYPE index, uint8_t uiType, TT_TIMER_TYPE uiValue) {
+    TTDelay_task_t* task = &tt->task[index];
+
+    if (!TTDelay_task_exists(tt, index))
+        return;
+    switch (uiType){
+    case TT_COMMAND_FROM_NOW:
+        TT_HOT(tt, index, uiTimeNextExecute)     = tt->current_time + uiValue;
+        TT_HOT(tt, index, uiNextExecuteOverflow) = TT_HOT(tt, index, uiTimeNextExecute) < tt->current_time;
+#if TT_TRACE
+        TTDelay_trace_r(tt, TT_TRACE_FROM_NOW, index, TT_HOT(tt, index, uiTimeNextExecute));
+#endif
+        // suspended tasks are not in the engine, a resume makes them due anyway.
+        // a running task is put back by TTDelay_task_end_r()
+        if (!(task->uiFlags & TT_TASK_SUSPENDED) && !TT_HOT(tt, index, fRunning))
+            TTDelay_engine_update(tt, index);
+        break;
+#ifndef TT_STATIC_TASKS
+    case TT_COMMAND_PERIOD:
+        // an implicit deadline follows the period
+        if (task->uiDeadline == task->uiPeriod)
+            task->uiDeadline = uiValue;
+        task->uiPeriod = uiValue;
+        if (uiValue)
+            task->uiFlags |= TT_TASK_IS_PERIODIC;
+        else
+            task->uiFlags &= ~TT_TASK_IS_PERIODIC;
+        break;
+    case TT_COMMAND_PRIORITY:
+        task->uiInitialPriority = (uint8_t)uiValue;
+#if TT_READY_BITMAP
+        // a due task is kept in the list of its priority level
+        if (TT_HOT(tt, index, fDue)){
+            TTDelay_level_unlink(tt, index);
+            TT_HOT(tt, index, uiCurrentPriority) = (uint8_t)uiValue;
+            TTDelay_level_push(tt, index);
+            break;
+        }
+#endif
+        TT_HOT(tt, index, uiCurrentPriority) = (uint8_t)uiValue;
+        break;
+#endif
+    case TT_COMMAND_SUSPEND:
+        TTDelay_suspend_task_r(tt, index);
+        break;
+    case TT_COMMAND_RESUME:
+        TTDelay_resume_task_r(tt, index);
+        break;
+    }
+}
+
+// a running task may be changing itself on a worker (TTDelay_pool.c), its
+// commands are held back until TTDelay_task_end_r(). a later command of the
+// same type replaces the held one, SUSPEND and RESUME replace each other.
+static void TTDelay_apply_command(TTDelay_t* tt, TT_TASK_INDEX_TYPE index, uint8_t uiType, TT_TIMER_TYPE uiValue) {
+    TTDelay_task_t* task = &tt->task[index];
+
+    if ((index >= tt->task_count) || !TT_HOT(tt, index, fRunning)){
+        TTDelay_execute_command(tt, index, uiType, uiValue);
+        return;
+    }
+    if (uiType == TT_COMMAND_FROM_NOW)
+        task->uiHeldFromNow = uiValue;
+    else if (uiType == TT_COMMAND_PERIOD)
+        task->uiHeldPeriod = uiValue;
+    else if (uiType == TT_COMMAND_PRIORITY)
+        task->uiHeldPriority = (uint8_t)uiValue;
+    else
+        task->uiHeldCommands &= ~((1 << TT_COMMAND_SUSPEND) | (1 << TT_COMMAND_RESUME));
+    task->uiHeldCommands |= 1 << uiType;
+}
+
+/* apply the commands held back while the task was running, called by
+ * TTDelay_task_end_r() before the task is put back. the next execute time is
+ * set after the period, so it wins over the rescheduling of the run. */
+static void TTDelay_release_commands(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TTDelay_task_t* task = &tt->task[index];
+    uint8_t         held = task->uiHeldCommands;
+
+    task->uiHeldCommands = 0;
+    if (held & (1 << TT_COMMAND_PERIOD))
+        TTDelay_execute_command(tt, index, TT_COMMAND_PERIOD, task->uiHeldPeriod);
+    if (held & (1 << TT_COMMAND_PRIORITY))
+        TTDelay_execute_command(tt, index, TT_COMMAND_PRIORITY, task->uiHeldPriority);
+    if (held & (1 << TT_COMMAND_FROM_NOW))
+        TTDelay_execute_command(tt, index, TT_COMMAND_FROM_NOW, task->uiHeldFromNow);
+    if (held & (1 << TT_COMMAND_SUSPEND))
+        TTDelay_execute_command(tt, index, TT_COMMAND_SUSPEND, 0);
+    if (held & (1 << TT_COMMAND_RESUME))
+        TTDelay_execute_command(tt, index, TT_COMMAND_RESUME, 0);
+}
+
+/* apply the commands posted since the last call. stops at a slot that was
+ * claimed but is still being written, the rest follows with the next call. */
+static void TTDelay_take_commands(TTDelay_t* tt) {
+    while (1){
+        uint32_t           pos  = tt->command_head;
+        TTDelay_command_t* slot = &tt->command[pos % TT_COMMAND_QUEUE_SIZE];
+        if (TT_ATOMIC_LOAD(&slot->uiSequence) + pos % TT_COMMAND_QUEUE_SIZE != pos + 1)
+            return;
+        TTDelay_apply_command(tt, slot->uiTask, slot->uiType, slot->uiValue);
+        // free for the producers of the next lap
+        TT_ATOMIC_STORE(&slot->uiSequence, pos + TT_COMMAND_QUEUE_SIZE - pos % TT_COMMAND_QUEUE_SIZE);
+        tt->command_head = pos + 1;
+    }
+}
+#endif
+
+#if TT_SCHEDULE_TABLE
+// order of the slots at the same offset: priority, then task index
+static int TTDelay_slot_before(TTDelay_t* tt, const TTDelay_slot_t* a, const TTDelay_slot_t* b) {
+    if (a->uiOffset != b->uiOffset)
+        return a->uiOffset < b->uiOffset;
+    if (TT_CONST(tt, a->uiTask, uiInitialPriority) != TT_CONST(tt, b->uiTask, uiInitialPriority))
+        return TT_CONST(tt, a->uiTask, uiInitialPriority) < TT_CONST(tt, b->uiTask, uiInitialPriority);
+    return a->uiTask < b->uiTask;
+}
+
+/* run a task of the schedule table. the engine is not touched, rescheduling
+ * done by the task has no effect on the table. */
+static void TTDelay_table_dispatch(TTDelay_t* tt, TT_TASK_INDEX_TYPE index, TT_TIMER_TYPE uiTime) {
+    TTDelay_task_t*    task           = &tt->task[index];
+    TTDelay_t*         previous       = ttCurrent;
+    TT_TASK_INDEX_TYPE previous_index = ttCurrentTask;
+    TT_CPU_TICK_TYPE   uiExecuteTime  = 0;
+
+    if (task->uiFlags & (TT_TASK_SUSPENDED | TT_TASK_DELETED))
+        return;
+    TTDelay_idle_measure(tt);
+    tt->current_time        = uiTime;
+    tt->current_task_index  = index;
+    task->uiTimeLastExecute = uiTime;
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_TASK_START, index, uiTime);
+#endif
+    ttCurrent               = tt;
+    ttCurrentTask           = index;
+    TT_CONST(tt, index, func)(TT_CONST(tt, index, pvFuncParameterIn), TT_CONST(tt, index, pvFuncParameterOut));
+    ttCurrent               = previous;
+    ttCurrentTask           = previous_index;
+
+    TTDelay_time_measure(tt, &uiExecuteTime);
+    TTDelay_cpu_usage_update(tt, task);
+    task->timeRunning      += uiExecuteTime;
+    if (uiExecuteTime > task->uiLongestExecuteDuration)
+        task->uiLongestExecuteDuration = uiExecuteTime;
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_TASK_END, index, uiExecuteTime);
+#endif
+}
+#endif
+
+#if TT_SCAN_MASK
+/* sets bit i of tt->due_mask if task i is due: next execute time reached, no
+ * overflow pending and not running. 32 tasks per mask word, AVX2 or SSE2 if the
+ * compiler targets them (-mavx2, x86-64 always has SSE2), portable code otherwise. */
+static void TTDelay_scan_kernel(TTDelay_t* tt, unsigned int count) {
+    const TT_TIMER_TYPE* next    = tt->hot.uiTimeNextExecute;
+    const uint8_t*       ovf     = tt->hot.uiNextExecuteOverflow;
+    const uint8_t*       running = tt->hot.fRunning;
+    unsigned int         i       = 0;
+
+#if defined(__AVX2__)
+    if ((sizeof(TT_TIMER_TYPE) == 4) || (sizeof(TT_TIMER_TYPE) == 2)){
+        const __m256i zero = _mm256_setzero_si256();
+        // no unsigned compare, flip the sign bit of both sides instead
+        const __m256i bias = (sizeof(TT_TIMER_TYPE) == 4) ? _mm256_set1_epi32(INT32_MIN) : _mm256_set1_epi16(INT16_MIN);
+        const __m256i now  = _mm256_xor_si256(bias, (sizeof(TT_TIMER_TYPE) == 4)
+            ? _mm256_set1_epi32((int32_t)tt->current_time) : _mm256_set1_epi16((int16_t)tt->current_time));
+        for ( ; i + 32 <= count ; i += 32){
+            uint32_t later = 0;     // bit set: next execute time > current time
+            if (sizeof(TT_TIMER_TYPE) == 4){
+                for (unsigned int k = 0 ; k < 32 ; k += 8){
+                    __m256i n = _mm256_xor_si256(bias, _mm256_loadu_si256((const __m256i*)(next + i + k)));
+                    later |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(n, now))) << k;
+                }
+            } else {
+                __m256i n0 = _mm256_xor_si256(bias, _mm256_loadu_si256((const __m256i*)(next + i)));
+                __m256i n1 = _mm256_xor_si256(bias, _mm256_loadu_si256((const __m256i*)(next + i + 16)));
+                // packing works per 128 bit lane, put the quarters back in order
+                __m256i c  = _mm256_packs_epi16(_mm256_cmpgt_epi16(n0, now), _mm256_cmpgt_epi16(n1, now));
+                later      = (uint32_t)_mm256_movemask_epi8(_mm256_permute4x64_epi64(c, 0xD8));
+            }
+            __m256i  blocked = _mm256_or_si256(_mm256_loadu_si256((const __m256i*)(ovf + i)),
+                                               _mm256_loadu_si256((const __m256i*)(running + i)));
+            uint32_t unblocked = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(blocked, zero));
+            tt->due_mask[i / 32] = unblocked & ~later;
+        }
+    }
+#elif defined(__SSE2__)
+    if ((sizeof(TT_TIMER_TYPE) == 4) || (sizeof(TT_TIMER_TYPE) == 2)){
+        const __m128i zero = _mm_setzero_si128();
+        // no unsigned compare, flip the sign bit of both sides instead
+        const __m128i bias = (sizeof(TT_TIMER_TYPE) == 4) ? _mm_set1_epi32(INT32_MIN) : _mm_set1_epi16(INT16_MIN);
+        const __m128i now  = _mm_xor_si128(bias, (sizeof(TT_TIMER_TYPE) == 4)
+            ? _mm_set1_epi32((int32_t)tt->current_time) : _mm_set1_epi16((int16_t)tt->current_time));
+        for ( ; i + 32 <= count ; i += 32){
+            uint32_t later = 0;     // bit set: next execute time > current time
+            if (sizeof(TT_TIMER_TYPE) == 4){
+                for (unsigned int k = 0 ; k < 32 ; k += 4){
+                    __m128i n = _mm_xor_si128(bias, _mm_loadu_si128((const __m128i*)(next + i + k)));
+                    later |= (uint32_t)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(n, now))) << k;
+                }
+            } else {
+                for (unsigned int k = 0 ; k < 32 ; k += 16){
+                    __m128i n0 = _mm_xor_si128(bias, _mm_loadu_si128((const __m128i*)(next + i + k)));
+                    __m128i n1 = _mm_xor_si128(bias, _mm_loadu_si128((const __m128i*)(next + i + k + 8)));
+                    later |= (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(_mm_cmpgt_epi16(n0, now), _mm_cmpgt_epi16(n1, now))) << k;
+                }
+            }
+            uint32_t unblocked = 0;
+            for (unsigned int k = 0 ; k < 32 ; k += 16){
+                __m128i blocked = _mm_or_si128(_mm_loadu_si128((const __m128i*)(ovf + i + k)),
+                                               _mm_loadu_si128((const __m128i*)(running + i + k)));
+                unblocked |= (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(blocked, zero)) << k;
+            }
+            tt->due_mask[i / 32] = unblocked & ~later;
+        }
+    }
+#endif
+    // the rest (and other timer sizes), branch free so the compiler may vectorize it
+    for ( ; i < count ; i += 32){
+        uint32_t     word = 0;
+        unsigned int end  = (count - i < 32) ? count - i : 32;
+        for (unsigned int k = 0 ; k < end ; k++){
+            word |= (uint32_t)((tt->current_time >= next[i + k]) & !ovf[i + k] & !running[i + k]) << k;
+        }
+        tt->due_mask[i / 32] = word;
+    }
+}
+
+/* TTDelay_find_due_tasks_r(tt) for tasks 0..task_count-1 without holes: the
+ * kernel builds the due mask, then only the due tasks are looked at */
+static void TTDelay_scan_due_mask(TTDelay_t* tt, uint8_t resetNextExecuteOverflow) {
+    unsigned int count = tt->task_count;
+
+    if (resetNextExecuteOverflow){
+        for (unsigned int i = 0 ; i < count ; i++){
+            if (!tt->hot.fRunning[i])
+                tt->hot.uiNextExecuteOverflow[i] = 0;
+        }
+    }
+    TTDelay_scan_kernel(tt, count);
+    memset(tt->hot.fDue, 0, count);
+    for (unsigned int w = 0 ; w < (count + 31) / 32 ; w++){
+        for (uint32_t word = tt->due_mask[w] ; word ; word &= word - 1){
+            TT_TASK_INDEX_TYPE i = (TT_TASK_INDEX_TYPE)(w * 32 + TT_CTZ32(word));
+            tt->hot.fDue[i] = 1;
+            tt->task_scheduled_count++;
+            // ascending index, so the first task of a priority wins a tie
+            if ((tt->task_scheduled_count == 1) || TT_DUE_FIRST(tt, i)){
+                tt->highest_priority_value = tt->hot.uiCurrentPriority[i];
+                tt->highest_priority_index = i;
+            }
+        }
+    }
 }
+#endif
 
 /* compare the current time and a tasks next execute time to find out what tasks
  * should be run */
-void TTDelay_find_due_tasks(void) {
-    ttSystem.current_time = TT_TIMER_FUNC;
-    ttSystem.highest_priority_value = 255;
-    ttSystem.highest_priority_index = TT_TASK_COUNT_MAX + 1;
-    ttSystem.task_scheduled_count = 0;
-    TTDelay_task_t *task = &ttSystem.task[0];
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+void TTDelay_find_due_tasks_r(TTDelay_t* tt) {
+    tt->current_time = TT_TIMER_FUNC;
+    tt->highest_priority_value = 255;
+    tt->highest_priority_index = TT_TASK_COUNT_MAX + 1;
+#if TT_TASK_EVENTS
+    TTDelay_take_events(tt);
+#endif
+#if TT_TASK_COMMANDS
+    TTDelay_take_commands(tt);
+#endif
+    tt->task_scheduled_count = 0;
     uint8_t resetNextExecuteOverflow = 0;
     
-    if (ttSystem.current_time < ttSystem.last_run_time){
+    if (tt->current_time < tt->last_run_time){
         resetNextExecuteOverflow = 1;
     }
 
-    for (int i = 0 ; i < ttSystem.task_count ; i++, task++){
+    // suspended and deleted tasks are not in the active list. as long as there
+    // are none, the tasks are looked at directly (faster than the indirection)
+    const TT_TASK_INDEX_TYPE* active = (tt->active_count < tt->task_count) ? tt->active : 0;
+#if TT_SCAN_MASK
+    if (!active){
+        TTDelay_scan_due_mask(tt, resetNextExecuteOverflow);
+        return;
+    }
+#endif
+    TT_TASK_INDEX_TYPE active_count  = tt->active_count;
+    for (TT_TASK_INDEX_TYPE a = 0 ; a < active_count ; a++){
+        TT_TASK_INDEX_TYPE i    = active ? active[a] : a;
         // assume task is not scheduled
-        task->fDue = 0;
+        TT_HOT(tt, i, fDue) = 0;
+        // running on another thread (TTDelay_pool.c), must not be started twice
+        if (TT_HOT(tt, i, fRunning))
+            continue;
         // unset overflow flag if time had an overflow as well
         if (resetNextExecuteOverflow){
-            task->uiNextExecuteOverflow = 0;
+            TT_HOT(tt, i, uiNextExecuteOverflow) = 0;
         }
         // add task to "due" list if necessary
-        if ((ttSystem.current_time >= task->uiTimeNextExecute)
-        & (! task->uiNextExecuteOverflow)) {
-            task->fDue = 1;
-            ttSystem.task_scheduled_count++;
+        if ((tt->current_time >= TT_HOT(tt, i, uiTimeNextExecute))
+        & (! TT_HOT(tt, i, uiNextExecuteOverflow))) {
+            TT_HOT(tt, i, fDue) = 1;
+            tt->task_scheduled_count++;
             // find out if priority of this task is highest (low number -> higher priority)
-            if (task->uiCurrentPriority < ttSystem.highest_priority_value){
-                ttSystem.highest_priority_value = task->uiCurrentPriority;
-                ttSystem.highest_priority_index = i;
+            // the first due task is always taken, it might have priority 255.
+            // the active list is not ordered, lower index wins a tie
+            if ((tt->task_scheduled_count == 1) || TT_DUE_FIRST(tt, i)){
+                tt->highest_priority_value = TT_HOT(tt, i, uiCurrentPriority);
+                tt->highest_priority_index = i;
             }
         }
     }
 }
+#endif
+
+// add aging to the task to make sure low priority tasks are executed at some point\
+maximum aging is set by TT_PRIORITY_MAX_CHANGE and TT_PRIORITY_THRESHOLD sets a\
+hard limit to how low a tasks priority can get through aging.
+static void TTDelay_age_task(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    if ((TT_HOT(tt, index, uiCurrentPriority) > TT_PRIORITY_THRESHOLD) \
+        && (TT_HOT(tt, index, uiCurrentPriority) \
+            > (TT_CONST(tt, index, uiInitialPriority) - TT_PRIORITY_MAX_CHANGE))){
+#if TT_READY_BITMAP
+        // due tasks are kept in the list of their priority level, move it one up
+        TTDelay_level_unlink(tt, index);
+        TT_HOT(tt, index, uiCurrentPriority)--;
+        TTDelay_level_push(tt, index);
+#else
+        TT_HOT(tt, index, uiCurrentPriority)--;
+#endif
+#if TT_TRACE
+        TTDelay_trace_r(tt, TT_TRACE_AGING, index, TT_HOT(tt, index, uiCurrentPriority));
+#endif
+    }
+}
 
 /* Aging for tasks that are scheduled but not run right now */
-void TTDelay_adjust_priority(void) {
+void TTDelay_adjust_priority_r(TTDelay_t* tt) {
     // just one task scheduled? then we have no tasks to adjust
-    if (ttSystem.task_scheduled_count == 1)
+    if (tt->task_scheduled_count == 1)
         return;
 
-    TTDelay_task_t  *task = &ttSystem.task[0];
-
-    for (int i = 0 ; i < ttSystem.task_count ; i++, task++){
-        if (task->fDue){
-            if (i != ttSystem.highest_priority_index){
-                // add aging to the task to make sure low priority tasks are executed at some point\
-                maximum aging is set by TT_PRIORITY_MAX_CHANGE and TT_PRIORITY_THRESHOLD sets a\
-                hard limit to how low a tasks priority can get through aging.
-                if ((task->uiCurrentPriority > TT_PRIORITY_THRESHOLD) \
-                    && (task->uiCurrentPriority \
-                        > (task->uiInitialPriority - TT_PRIORITY_MAX_CHANGE)))
-                    task->uiCurrentPriority--;
+#if TT_READY_BITMAP && (TT_PRIORITY_MAX_CHANGE >= 255)
+    // every due task above the threshold ages: walk the used levels upwards
+    // and append each list as a whole to the level below, which was done
+    // already. the task that runs next is taken out first.
+    TT_TASK_INDEX_TYPE highest = tt->highest_priority_index;
+    TTDelay_level_unlink(tt, highest);
+    for (uint16_t level = TTDelay_level_used(tt, TT_PRIORITY_THRESHOLD + 1) ; level < 256 ;
+         level = TTDelay_level_used(tt, level + 1)){
+        for (TT_TASK_INDEX_TYPE entry = tt->level_head[level] ; entry ; entry = tt->level_next[entry - 1]){
+            TT_HOT(tt, entry - 1, uiCurrentPriority)--;
+#if TT_TRACE
+            TTDelay_trace_r(tt, TT_TRACE_AGING, entry - 1, level - 1);
+#endif
+        }
+        TTDelay_level_splice(tt, level);
+    }
+    TTDelay_level_push(tt, highest);
+#elif TT_READY_BITMAP
+    // walk the used levels upwards, an aged task moves to the level below
+    // which was done already. levels up to the threshold do not age.
+    for (uint16_t level = TTDelay_level_used(tt, TT_PRIORITY_THRESHOLD + 1) ; level < 256 ;
+         level = TTDelay_level_used(tt, level + 1)){
+        TT_TASK_INDEX_TYPE entry = tt->level_head[level];
+        while (entry){
+            TT_TASK_INDEX_TYPE i = entry - 1;
+            entry = tt->level_next[i];
+            if (i != tt->highest_priority_index)
+                TTDelay_age_task(tt, i);
+        }
+    }
+#else
+#if TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR
+    // only the ready list holds due tasks, no need to look at the waiting ones
+    for (TT_TASK_INDEX_TYPE r = 0 ; r < tt->ready_count ; r++){
+        TT_TASK_INDEX_TYPE i = tt->ready[r];
+#else
+    for (TT_TASK_INDEX_TYPE a = 0 ; a < tt->active_count ; a++){
+        TT_TASK_INDEX_TYPE i = tt->active[a];
+#endif
+        if (TT_HOT(tt, i, fDue)){
+            if (i != tt->highest_priority_index){
+                TTDelay_age_task(tt, i);
             }
         }
     }
+#endif
 }
 
 
+// lower priority value first, lower index wins a tie. with TT_POLICY_EDF the
+// earlier deadline goes first, compared as difference so it works across the
+// timer overflow (deadlines of due tasks are less than half the range apart)
+static int TTDelay_due_before(TTDelay_t* tt, TT_TASK_INDEX_TYPE a, TT_TASK_INDEX_TYPE b) {
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TT_TIMER_TYPE diff = (TT_TIMER_TYPE)((TT_HOT(tt, a, uiTimeNextExecute) + tt->task[a].uiDeadline)
+                                       - (TT_HOT(tt, b, uiTimeNextExecute) + tt->task[b].uiDeadline));
+    if (diff)
+        return diff >> (sizeof(TT_TIMER_TYPE) * 8 - 1);
+#endif
+    if (TT_HOT(tt, a, uiCurrentPriority) != TT_HOT(tt, b, uiCurrentPriority))
+        return TT_HOT(tt, a, uiCurrentPriority) < TT_HOT(tt, b, uiCurrentPriority);
+    return a < b;
+}
+
+// max-heap on TTDelay_due_before() for the heap sort in TTDelay_get_due_tasks_r()
+static void TTDelay_due_sift_down(TTDelay_t* tt, TT_TASK_INDEX_TYPE* puiIndex, int pos, int count) {
+    TT_TASK_INDEX_TYPE index = puiIndex[pos];
+    while (1){
+        int child = 2 * pos + 1;
+        if (child >= count)
+            break;
+        if ((child + 1 < count) && TTDelay_due_before(tt, puiIndex[child], puiIndex[child + 1]))
+            child++;
+        if (!TTDelay_due_before(tt, index, puiIndex[child]))
+            break;
+        puiIndex[pos] = puiIndex[child];
+        pos = child;
+    }
+    puiIndex[pos] = index;
+}
+
+/* copy the indices of all due tasks found by the last TTDelay_find_due_tasks_r()
+ * to puiIndex (highest priority first, lower index wins a tie). returns the count */
+int TTDelay_get_due_tasks_r(TTDelay_t* tt, TT_TASK_INDEX_TYPE* puiIndex, int iMaxCount){
+    int count = 0;
+#if TT_READY_BITMAP
+    // the levels are sorted already, a tie is in the order the tasks became due
+    for (uint16_t level = TTDelay_level_used(tt, 0) ; level < 256 ; level = TTDelay_level_used(tt, level + 1)){
+        for (TT_TASK_INDEX_TYPE entry = tt->level_head[level] ; entry && (count < iMaxCount) ; entry = tt->level_next[entry - 1])
+            puiIndex[count++] = entry - 1;
+    }
+    return count;
+#elif TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR
+    for (TT_TASK_INDEX_TYPE r = 0 ; (r < tt->ready_count) && (count < iMaxCount) ; r++){
+        puiIndex[count++] = tt->ready[r];
+    }
+#else
+    if (iMaxCount > tt->task_scheduled_count)
+        iMaxCount = tt->task_scheduled_count;
+    for (TT_TASK_INDEX_TYPE a = 0 ; (a < tt->active_count) && (count < iMaxCount) ; a++){
+        if (TT_HOT(tt, tt->active[a], fDue))
+            puiIndex[count++] = tt->active[a];
+    }
+#endif
+    // heap sort by priority, O(k log k) for k due tasks and no extra memory
+    for (int i = count / 2 ; i > 0 ; i--){
+        TTDelay_due_sift_down(tt, puiIndex, i - 1, count);
+    }
+    for (int i = count - 1 ; i > 0 ; i--){
+        TT_TASK_INDEX_TYPE index = puiIndex[0];
+        puiIndex[0] = puiIndex[i];
+        puiIndex[i] = index;
+        TTDelay_due_sift_down(tt, puiIndex, 0, i);
+    }
+    return count;
+}
+
+/* run all tasks that are due, found with a single search and run in priority
+ * order. iMaxTasks limits the number of tasks run, uiMaxTime the ticks of
+ * TT_TIMER_FUNC the batch may take (0: no limit for either of them).
+ * Tasks left over because of a limit are aged and TT_MORE_TASKS_SCHEDULED
+ * is returned. */
+int TTDelay_run_batch_r(TTDelay_t* tt, int iMaxTasks, TT_TIMER_TYPE uiMaxTime) {
+    int count, run = 0, executed = 0;
+
+    TTDelay_idle_measure(tt);
+    TTDelay_find_due_tasks_r(tt);
+    if (!tt->task_scheduled_count)
+        return TT_OK;
+    count = TTDelay_get_due_tasks_r(tt, tt->batch, TT_TASK_COUNT_MAX);
+
+    for ( ; run < count ; run++){
+        // suspended or deleted by a task that ran before
+        if (!TT_HOT(tt, tt->batch[run], fDue))
+            continue;
+        if ((iMaxTasks > 0) && (executed >= iMaxTasks))
+            break;
+        if (uiMaxTime && executed && ((TT_TIMER_TYPE)(TT_TIMER_FUNC - tt->current_time) >= uiMaxTime))
+            break;
+        TTDelay_run_task_r(tt, tt->batch[run]);
+        executed++;
+    }
+    if (run == count)
+        return TT_OK;
+
+    #if TT_ENABLE_TASK_AGING
+    for (int i = run ; i < count ; i++){
+        if (TT_HOT(tt, tt->batch[i], fDue))
+            TTDelay_age_task(tt, tt->batch[i]);
+    }
+    #endif
+    return TT_MORE_TASKS_SCHEDULED;
+}
+
 /* execute the task function and track the time needed until completion */
-void TTDelay_run_task(int index){
+void TTDelay_run_task_r(TTDelay_t* tt, int index){
     // time management
-    int iExecuteTime            = 0;
-    TTDelay_task_t* task        = &ttSystem.task[index];    
-    task->uiTimeLastExecute     = ttSystem.current_time;
-    ttSystem.current_task_index = index;
-    TTDelay_time_measure(&ttSystem.uiCpuTtsysCycleTickCount);
+    TT_CPU_TICK_TYPE uiExecuteTime = 0;
+    TTDelay_task_begin_r(tt, index);
+    TTDelay_time_measure(tt, &tt->uiCpuTtsysCycleTickCount);
 
     // run task
-    task->func(task->pvFuncParameterIn, task->pvFuncParameterOut);
+    TTDelay_task_execute_r(tt, index);
+
+    // time management
+    TTDelay_time_measure(tt, &uiExecuteTime);
+    TTDelay_task_end_r(tt, index, (TT_TIMER_TYPE)uiExecuteTime);
+}
+
+/* A task run is split in three steps, so the function can be executed on
+ * another thread (see TTDelay_pool.c). begin and end are called by the thread
+ * that owns the instance, execute may be called from anywhere in between.
+ * While the task is running it is detached from the engine and ignored when
+ * looking for due tasks, so it can not be started twice. */
+void TTDelay_task_begin_r(TTDelay_t* tt, int index){
+    TTDelay_task_t* task        = &tt->task[index];
+    task->uiTimeLastExecute     = tt->current_time;
+    tt->current_task_index      = index;
+#if TT_LATENESS_STATS
+    TTDelay_lateness_add(tt, index);
+#endif
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_TASK_START, index, TT_HOT(tt, index, uiTimeNextExecute));
+#endif
+    // rescheduling is done on a detached task, it is put back in place afterwards
+    TTDelay_engine_remove(tt, index);
+    TT_HOT(tt, index, fDue)                  = 0;
+    TT_HOT(tt, index, fRunning)              = 1;
+}
+
+void TTDelay_task_execute_r(TTDelay_t* tt, int index){
+    TTDelay_task_t*    task             = &tt->task[index];
+    TTDelay_t*         previous         = ttCurrent;
+    TT_TASK_INDEX_TYPE previous_index   = ttCurrentTask;
+    ttCurrent                           = tt;
+    ttCurrentTask                       = index;
+
+    TT_CONST(tt, index, func)(TT_CONST(tt, index, pvFuncParameterIn), TT_CONST(tt, index, pvFuncParameterOut));
     // reset task to default
-    task->uiCurrentPriority     = task->uiInitialPriority;
+    TT_HOT(tt, index, uiCurrentPriority)     = TT_CONST(tt, index, uiInitialPriority);
     if (task->uiFlags & TT_TASK_IS_PERIODIC){
-        TTDelay_from_last(task->uiPeriod);
+        TTDelay_from_last(TT_CONST(tt, index, uiPeriod));
     }
 
-    // time management
-    ttSystem.last_run_time      = ttSystem.current_time;
-    TTDelay_time_measure(&iExecuteTime);
-    task->timeRunning           += iExecuteTime;
-    if (iExecuteTime > task->uiLongestExecuteDuration)
-        task->uiLongestExecuteDuration = iExecuteTime;
+    ttCurrent                   = previous;
+    ttCurrentTask               = previous_index;
 }
 
+void TTDelay_task_end_r(TTDelay_t* tt, int index, TT_TIMER_TYPE uiExecuteTime){
+    TTDelay_task_t* task        = &tt->task[index];
+#if TT_TASK_COMMANDS
+    TTDelay_release_commands(tt, index);
+#endif
+    // the task may have deleted or suspended itself, or was deleted or
+    // suspended while running: take it out before it is marked as not running
+    if (task->uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED))
+        TTDelay_task_detach(tt, index);
+    TT_HOT(tt, index, fRunning)              = 0;
+    tt->last_run_time           = tt->current_time;
+    // the run time of the monitor counts for the next interval
+    TTDelay_cpu_usage_update(tt, task);
+    task->timeRunning          += uiExecuteTime;
+#if TT_TASK_EVENTS
+    task->uiFlags              &= ~TT_TASK_NOTIFIED;
+#endif
+    if (uiExecuteTime > task->uiLongestExecuteDuration)
+        task->uiLongestExecuteDuration = uiExecuteTime;
+#if TT_EXEC_HISTOGRAM
+    TTDelay_histogram_add(&tt->histogram[index], uiExecuteTime);
+#endif
+#if TT_TRACE
+    TTDelay_trace_r(tt, TT_TRACE_TASK_END, index, uiExecuteTime);
+#endif
+    TTDelay_task_put_back(tt, index);
+}
 
-int TTDelay_get_remaining_idle_time(void) {
+/* undo TTDelay_task_begin_r() for a task whose function was never executed,
+ * e.g. when the pool is stopped before a worker took it. the task is due
+ * again, its statistics stay as they are (the lateness added by begin is
+ * kept, the execute time is not). */
+void TTDelay_task_cancel_r(TTDelay_t* tt, int index){
+    TTDelay_task_t* task        = &tt->task[index];
+#if TT_TASK_COMMANDS
+    TTDelay_release_commands(tt, index);
+#endif
+    if (task->uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED))
+        TTDelay_task_detach(tt, index);
+    TT_HOT(tt, index, fRunning)              = 0;
+    TTDelay_task_put_back(tt, index);
+}
 
+// last step of end and cancel, fRunning is already cleared
+static void TTDelay_task_put_back(TTDelay_t* tt, TT_TASK_INDEX_TYPE index){
+    TTDelay_task_t* task        = &tt->task[index];
+    if (task->uiFlags & TT_TASK_DELETED){
+        TTDelay_task_free(tt, index);
+        return;
+    }
+    if (task->uiFlags & TT_TASK_SUSPENDED)
+        return;
+    // the timer overflowed while the task was running on another thread
+    if (tt->current_time < task->uiTimeLastExecute)
+        TT_HOT(tt, index, uiNextExecuteOverflow) = 0;
+    TTDelay_engine_insert(tt, index);
 }
 
-TT_TIMER_TYPE TTDelay_get_next_schedule_time(int index){
-    return ttSystem.task[index].uiTimeNextExecute;
+
+/*******************************************************************************
+* S C H E D U L E R   E N G I N E
+*******************************************************************************/
+// tasks with an overflown next execute time are due after all others
+static int TTDelay_task_earlier(TTDelay_t* tt, TT_TASK_INDEX_TYPE a, TT_TASK_INDEX_TYPE b) {
+    if (TT_HOT(tt, a, uiNextExecuteOverflow) != TT_HOT(tt, b, uiNextExecuteOverflow))
+        return TT_HOT(tt, b, uiNextExecuteOverflow);
+    return TT_HOT(tt, a, uiTimeNextExecute) < TT_HOT(tt, b, uiTimeNextExecute);
 }
 
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+// the linear engine looks at every task in TTDelay_find_due_tasks_r(tt), nothing to track
+static void TTDelay_engine_insert(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {}
+static void TTDelay_engine_remove(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {}
+static void TTDelay_engine_update(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {}
 
-int TTDelay_get_task_count(void) {
-    return ttSystem.task_count;
+// the active list holds all tasks that are neither suspended nor deleted,
+// running tasks stay in it. removing a task has to search the list.
+static void TTDelay_task_attach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    tt->active[tt->active_count++] = index;
 }
 
-void TTDelay_set_idle_tick_count(TT_TIMER_TYPE uiTickCount){
-    ttSystem.uiCpuIdleCycleTickCount = uiTickCount;
+static void TTDelay_task_detach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    for (TT_TASK_INDEX_TYPE a = 0 ; a < tt->active_count ; a++){
+        if (tt->active[a] == index){
+            tt->active[a] = tt->active[--tt->active_count];
+            break;
+        }
+    }
+    TT_HOT(tt, index, fDue) = 0;
 }
 
-void TTDelay_set_ttsys_tick_count(TT_TIMER_TYPE uiTickCount){
-    ttSystem.uiCpuTtsysCycleTickCount = uiTickCount;
+// the task that is due next, TT_TASK_COUNT_MAX + 1 if there is none
+static TT_TASK_INDEX_TYPE TTDelay_engine_earliest(TTDelay_t* tt) {
+    TT_TASK_INDEX_TYPE earliest = TT_TASK_COUNT_MAX + 1;
+    for (TT_TASK_INDEX_TYPE a = 0 ; a < tt->active_count ; a++){
+        TT_TASK_INDEX_TYPE i = tt->active[a];
+        if (TT_HOT(tt, i, fRunning))
+            continue;
+        if ((earliest > TT_TASK_COUNT_MAX) || TTDelay_task_earlier(tt, i, earliest))
+            earliest = i;
+    }
+    return earliest;
 }
 
-float TTDelay_get_idle_time_percentage(void) {
-    return ttCpuLoad.rIdleUsage; 
+#else
+/* Every task is either waiting inside the engine (heap or wheel) or sitting in
+ * the ready list because it is due. fDue tells which one it is. A task that is
+ * running is in neither of them and is put back by TTDelay_run_task_r(tt). */
+static void TTDelay_engine_wait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_engine_unwait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index);
+static void TTDelay_engine_collect_due(TTDelay_t* tt, TT_TIMER_TYPE previous_time);
+
+#if TT_READY_BITMAP
+/* due tasks are also kept in one FIFO list per priority level. a bit per level
+ * (and one per 32 levels) tells which lists are used, so the highest priority
+ * task is found with two count-trailing-zeros, however many tasks are due.
+ * lists store task index + 1, 0 means "none". */
+static void TTDelay_level_push(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    uint8_t level = TT_HOT(tt, index, uiCurrentPriority);
+    uint32_t bit  = (uint32_t)1 << (level % 32);
+
+    tt->level_next[index] = 0;
+    if (tt->ready_levels[level / 32] & bit){
+        tt->level_prev[index] = tt->level_tail[level];
+        tt->level_next[tt->level_tail[level] - 1] = index + 1;
+    } else {
+        tt->level_prev[index]  = 0;
+        tt->level_head[level]  = index + 1;
+        tt->ready_levels[level / 32] |= bit;
+        tt->ready_summary      |= (uint8_t)(1 << (level / 32));
+    }
+    tt->level_tail[level] = index + 1;
 }
 
-float TTDelay_get_ttsys_time_percentage(void) {
-    return ttCpuLoad.rTtsysUsage; 
+static void TTDelay_level_unlink(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    uint8_t            level = TT_HOT(tt, index, uiCurrentPriority);
+    TT_TASK_INDEX_TYPE prev  = tt->level_prev[index];
+    TT_TASK_INDEX_TYPE next  = tt->level_next[index];
+
+    if (prev)
+        tt->level_next[prev - 1] = next;
+    else
+        tt->level_head[level] = next;
+    if (next)
+        tt->level_prev[next - 1] = prev;
+    else
+        tt->level_tail[level] = prev;
+    if (!tt->level_head[level]){
+        tt->ready_levels[level / 32] &= ~((uint32_t)1 << (level % 32));
+        if (!tt->ready_levels[level / 32])
+            tt->ready_summary &= (uint8_t)~(1 << (level / 32));
+    }
 }
 
-TTDelay_task_t* TTDelay_get_task(int index){
-    if ((index >= 0) && (index < ttSystem.task_count))
-        return &ttSystem.task[index];
-    return (TTDelay_task_t*)0;
+#if TT_PRIORITY_MAX_CHANGE >= 255
+// append the whole list of a level to the list of the level below
+static void TTDelay_level_splice(TTDelay_t* tt, uint8_t level) {
+    uint8_t  below = level - 1;
+    uint32_t bit   = (uint32_t)1 << (below % 32);
+
+    if (tt->ready_levels[below / 32] & bit){
+        tt->level_next[tt->level_tail[below] - 1] = tt->level_head[level];
+        tt->level_prev[tt->level_head[level] - 1] = tt->level_tail[below];
+    } else {
+        tt->level_head[below] = tt->level_head[level];
+        tt->ready_levels[below / 32] |= bit;
+        tt->ready_summary      |= (uint8_t)(1 << (below / 32));
+    }
+    tt->level_tail[below] = tt->level_tail[level];
+    tt->level_head[level] = 0;
+    tt->ready_levels[level / 32] &= ~((uint32_t)1 << (level % 32));
+    if (!tt->ready_levels[level / 32])
+        tt->ready_summary &= (uint8_t)~(1 << (level / 32));
 }
+#endif
 
-int TTDelay_is_due(int index){
-    // if task exists, return due status
-    if ((index >= 0) && (index < ttSystem.task_count))
-        return ttSystem.task[index].fDue;
-    return 0;
+// lowest used level >= from, 256 if there is none
+static uint16_t TTDelay_level_used(TTDelay_t* tt, uint16_t from) {
+    uint8_t  word;
+    uint32_t bits;
+    uint8_t  summary;
+
+    if (from >= 256)
+        return 256;
+    word = from / 32;
+    bits = tt->ready_levels[word] & (~(uint32_t)0 << (from % 32));
+    if (bits)
+        return word * 32 + TT_CTZ32(bits);
+    summary = tt->ready_summary & (uint8_t)(0xFF << (word + 1));
+    if (!summary)
+        return 256;
+    word = TT_CTZ32(summary);
+    return word * 32 + TT_CTZ32(tt->ready_levels[word]);
 }
 
-uint8_t TTDelay_get_next_scheduled(void) {
-    return ttSystem.highest_priority_index;
+// the levels are rebuilt from the ready list after a timer overflow
+static void TTDelay_level_clear(TTDelay_t* tt) {
+    for (uint8_t word = 0 ; word < 8 ; word++)
+        tt->ready_levels[word] = 0;
+    tt->ready_summary = 0;
 }
+#endif
 
-void* TTDelay_get_task_input_param_pointer(int index){
-    if ((index >= 0) && (index < ttSystem.task_count)){
-        return ttSystem.task[index].pvFuncParameterIn;
+static void TTDelay_ready_add(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TT_HOT(tt, index, fDue) = 1;
+    tt->position[index]  = tt->ready_count;
+    tt->ready[tt->ready_count++] = index;
+#if TT_READY_BITMAP
+    TTDelay_level_push(tt, index);
+#endif
+}
+
+static void TTDelay_ready_remove(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    // ready list is unordered, fill the gap with its last entry
+    TT_TASK_INDEX_TYPE pos  = tt->position[index];
+    TT_TASK_INDEX_TYPE last = tt->ready[--tt->ready_count];
+    tt->ready[pos]     = last;
+    tt->position[last] = pos;
+    TT_HOT(tt, index, fDue) = 0;
+#if TT_READY_BITMAP
+    TTDelay_level_unlink(tt, index);
+#endif
+}
+
+static void TTDelay_engine_insert(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TT_HOT(tt, index, fDue) = 0;
+    TTDelay_engine_wait(tt, index);
+}
+
+static void TTDelay_engine_remove(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    if (TT_HOT(tt, index, fRunning))
+        return;
+    if (TT_HOT(tt, index, fDue))
+        TTDelay_ready_remove(tt, index);
+    else
+        TTDelay_engine_unwait(tt, index);
+}
+
+// next execute time of a task changed while it was not running
+static void TTDelay_engine_update(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    if (TT_HOT(tt, index, fRunning))
+        return;
+    TTDelay_engine_remove(tt, index);
+    TTDelay_engine_insert(tt, index);
+}
+
+// suspended and deleted tasks are kept out of the engine, a running task is
+// put back by TTDelay_task_end_r(tt)
+static void TTDelay_task_attach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    if (!TT_HOT(tt, index, fRunning))
+        TTDelay_engine_insert(tt, index);
+}
+
+static void TTDelay_task_detach(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TTDelay_engine_remove(tt, index);
+}
+
+/* let the engine move all tasks that are due to the ready list and pick the one
+ * with highest priority from the ready list. */
+void TTDelay_find_due_tasks_r(TTDelay_t* tt) {
+    TT_TIMER_TYPE previous_time = tt->current_time;
+    tt->current_time = TT_TIMER_FUNC;
+    tt->highest_priority_value = 255;
+    tt->highest_priority_index = TT_TASK_COUNT_MAX + 1;
+#if TT_TASK_EVENTS
+    TTDelay_take_events(tt);
+#endif
+#if TT_TASK_COMMANDS
+    TTDelay_take_commands(tt);
+#endif
+
+    TTDelay_engine_collect_due(tt, previous_time);
+    tt->task_scheduled_count = tt->ready_count;
+
+#if TT_READY_BITMAP
+    // head of the lowest used level, the task that became due first wins a tie
+    if (tt->ready_summary){
+        uint16_t level = TTDelay_level_used(tt, 0);
+        tt->highest_priority_value = (uint8_t)level;
+        tt->highest_priority_index = tt->level_head[level] - 1;
+    }
+    return;
+#endif
+    // find the highest priority (low number) due task, lower index wins a tie
+    for (TT_TASK_INDEX_TYPE r = 0 ; r < tt->ready_count ; r++){
+        TT_TASK_INDEX_TYPE index = tt->ready[r];
+        if ((r == 0) || TT_DUE_FIRST(tt, index)){
+            tt->highest_priority_value = TT_HOT(tt, index, uiCurrentPriority);
+            tt->highest_priority_index = index;
+        }
     }
-    return (void*)0;
 }
 
-void* TTDelay_get_task_output_param_pointer(int index){
-    if ((index >= 0) && (index < ttSystem.task_count))
-        return ttSystem.task[index].pvFuncParameterOut;
-    return (void*)0;
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_HEAP
+/* waiting tasks sit in a binary min-heap ordered by next execute time,
+ * position[] holds the index inside heap[] */
+
+static void TTDelay_heap_place(TTDelay_t* tt, TT_TASK_INDEX_TYPE pos, TT_TASK_INDEX_TYPE index) {
+    tt->heap[pos]       = index;
+    tt->position[index] = pos;
 }
 
-int TTDelay_get_task_scheduled_count(void) {
-    return ttSystem.task_scheduled_count;
+static void TTDelay_heap_sift_up(TTDelay_t* tt, TT_TASK_INDEX_TYPE pos) {
+    TT_TASK_INDEX_TYPE index = tt->heap[pos];
+    while (pos > 0){
+        TT_TASK_INDEX_TYPE parent = (pos - 1) / 2;
+        if (!TTDelay_task_earlier(tt, index, tt->heap[parent]))
+            break;
+        TTDelay_heap_place(tt, pos, tt->heap[parent]);
+        pos = parent;
+    }
+    TTDelay_heap_place(tt, pos, index);
 }
 
-void TTDelay_calculate_cpu_usage(void) {
-    TTDelay_task_t* task = (TTDelay_task_t*)ttSystem.task;
-    TT_TIMER_TYPE uiTotalTime = ttSystem.uiCpuIdleCycleTickCount + ttSystem.uiCpuTtsysCycleTickCount;
-    for (int i = 0 ; i < ttSystem.task_count ; i++, task++){
-        uiTotalTime += task->timeRunning;
+static void TTDelay_heap_sift_down(TTDelay_t* tt, TT_TASK_INDEX_TYPE pos) {
+    TT_TASK_INDEX_TYPE index = tt->heap[pos];
+    while (1){
+        uint32_t child = 2 * (uint32_t)pos + 1;
+        if (child >= tt->heap_count)
+            break;
+        if ((child + 1 < tt->heap_count)
+        && TTDelay_task_earlier(tt, tt->heap[child + 1], tt->heap[child]))
+            child++;
+        if (!TTDelay_task_earlier(tt, tt->heap[child], index))
+            break;
+        TTDelay_heap_place(tt, pos, tt->heap[child]);
+        pos = child;
     }
-    // overflow detection
-    if (    (uiTotalTime < ttSystem.uiCpuIdleCycleTickCount) \
-        ||  (uiTotalTime < ttSystem.uiCpuTtsysCycleTickCount))
+    TTDelay_heap_place(tt, pos, index);
+}
+
+static void TTDelay_heap_remove_at(TTDelay_t* tt, TT_TASK_INDEX_TYPE pos) {
+    TT_TASK_INDEX_TYPE last = tt->heap[--tt->heap_count];
+    if (pos == tt->heap_count)
         return;
+    // the last entry fills the gap and may have to move either way
+    TTDelay_heap_place(tt, pos, last);
+    TTDelay_heap_sift_down(tt, pos);
+    TTDelay_heap_sift_up(tt, tt->position[last]);
+}
+
+static void TTDelay_engine_wait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TTDelay_heap_place(tt, tt->heap_count++, index);
+    TTDelay_heap_sift_up(tt, tt->heap_count - 1);
+}
+
+static void TTDelay_engine_unwait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TTDelay_heap_remove_at(tt, tt->position[index]);
+}
+
+static TT_TASK_INDEX_TYPE TTDelay_engine_earliest(TTDelay_t* tt) {
+    if (tt->ready_count)
+        return tt->ready[0];
+    if (tt->heap_count)
+        return tt->heap[0];
+    return TT_TASK_COUNT_MAX + 1;
+}
 
-    task = (TTDelay_task_t*)ttSystem.task;
-    for (int i = 0 ; i < ttSystem.task_count ; i++, task++){
-        ttCpuLoad.rTaskUsage[i] = (float)task->timeRunning / uiTotalTime;
+static void TTDelay_engine_collect_due(TTDelay_t* tt, TT_TIMER_TYPE previous_time) {
+    // timer overflow: next execute times that overflowed are valid now and due
+    // tasks might not be due anymore. rebuild the heap from scratch (O(n), rare)
+    if (tt->current_time < previous_time){
+        while (tt->ready_count){
+            TT_TASK_INDEX_TYPE index = tt->ready[--tt->ready_count];
+            TT_HOT(tt, index, fDue) = 0;
+            TTDelay_heap_place(tt, tt->heap_count++, index);
+        }
+#if TT_READY_BITMAP
+        TTDelay_level_clear(tt);
+#endif
+        for (TT_TASK_INDEX_TYPE i = 0 ; i < tt->heap_count ; i++){
+            TT_HOT(tt, tt->heap[i], uiNextExecuteOverflow) = 0;
+        }
+        for (TT_TASK_INDEX_TYPE i = tt->heap_count / 2 ; i > 0 ; i--){
+            TTDelay_heap_sift_down(tt, i - 1);
+        }
+    }
+
+    // nothing due is a single compare against the earliest waiting task
+    while (tt->heap_count){
+        TT_TASK_INDEX_TYPE index = tt->heap[0];
+        if ((TT_HOT(tt, index, uiNextExecuteOverflow)) || (tt->current_time < TT_HOT(tt, index, uiTimeNextExecute)))
+            break;
+        TTDelay_heap_remove_at(tt, 0);
+        TTDelay_ready_add(tt, index);
     }
-    ttCpuLoad.rIdleUsage  = (float)ttSystem.uiCpuIdleCycleTickCount  / uiTotalTime;
-    ttCpuLoad.rTtsysUsage = (float)ttSystem.uiCpuTtsysCycleTickCount / uiTotalTime;
 }
 
-void TTDelay_reset_time_running(void) {
-    TTDelay_task_t* task = (TTDelay_task_t*)ttSystem.task;
-    for (int i = 0 ; i < ttSystem.task_count ; i++, task++){
-        task->timeRunning = 0;
+#elif TT_SCHEDULER_ENGINE == TT_ENGINE_WHEEL
+/* hierarchical timing wheel. A task waits on level L when its next execute time
+ * and the wheel time first differ in bit group L (TT_WHEEL_BITS bits per level),
+ * in the slot given by that bit group of its next execute time. When the wheel
+ * time moves on, the slots it passed are emptied and their tasks are either due
+ * or cascade down to a lower level. Tasks with an overflown next execute time
+ * wait in an extra list until the timer overflows as well.
+ * Every slot is a double linked list, wheel_used[] has one bit per non empty
+ * slot so empty slots are skipped without looking at them. */
+
+static uint8_t TTDelay_ctz64(uint64_t value) {
+#if defined(__GNUC__)
+    return __builtin_ctzll(value);
+#else
+    uint8_t n = 0;
+    while (!(value & 1)){
+        value >>= 1;
+        n++;
     }
-    ttSystem.uiCpuIdleCycleTickCount  = 0;
-    ttSystem.uiCpuTtsysCycleTickCount = 0;
+    return n;
+#endif
 }
 
-TTDelay_cpu_usage_TypDef* TTDelay_get_cpu_usage_pointer(void) {
-    return &ttCpuLoad;
+// lists store task index + 1, so 0 (what TTDelay_reset_r(tt) leaves) means "none"
+static void TTDelay_wheel_link(TTDelay_t* tt, uint16_t list, TT_TASK_INDEX_TYPE index) {
+    TT_TASK_INDEX_TYPE head     = tt->wheel_head[list];
+    tt->wheel_list[index]  = list;
+    tt->wheel_prev[index]  = 0;
+    tt->wheel_next[index]  = head;
+    if (head)
+        tt->wheel_prev[head - 1] = index + 1;
+    tt->wheel_head[list]   = index + 1;
+    if (list != TT_WHEEL_OVERFLOW_LIST)
+        tt->wheel_used[list / TT_WHEEL_SLOTS] |= (uint64_t)1 << (list % TT_WHEEL_SLOTS);
+}
+
+static void TTDelay_engine_wait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TT_TIMER_TYPE   diff;
+    uint8_t         level = 0;
+
+    if (TT_HOT(tt, index, uiNextExecuteOverflow)){
+        TTDelay_wheel_link(tt, TT_WHEEL_OVERFLOW_LIST, index);
+        return;
+    }
+    if (TT_HOT(tt, index, uiTimeNextExecute) <= tt->wheel_time){
+        TTDelay_ready_add(tt, index);
+        return;
+    }
+    // level: highest bit group in which next execute time and wheel time differ
+    diff = TT_HOT(tt, index, uiTimeNextExecute) ^ tt->wheel_time;
+    while ((level + 1 < TT_WHEEL_LEVELS) && (diff >> (TT_WHEEL_BITS * (level + 1))))
+        level++;
+    TTDelay_wheel_link(tt, level * TT_WHEEL_SLOTS
+        + ((TT_HOT(tt, index, uiTimeNextExecute) >> (TT_WHEEL_BITS * level)) & (TT_WHEEL_SLOTS - 1)), index);
+}
+
+static void TTDelay_engine_unwait(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    uint16_t           list = tt->wheel_list[index];
+    TT_TASK_INDEX_TYPE next = tt->wheel_next[index];
+    TT_TASK_INDEX_TYPE prev = tt->wheel_prev[index];
+    if (next)
+        tt->wheel_prev[next - 1] = prev;
+    if (prev)
+        tt->wheel_next[prev - 1] = next;
+    else
+        tt->wheel_head[list] = next;
+    if ((!tt->wheel_head[list]) && (list != TT_WHEEL_OVERFLOW_LIST))
+        tt->wheel_used[list / TT_WHEEL_SLOTS] &= ~((uint64_t)1 << (list % TT_WHEEL_SLOTS));
+}
+
+// take all tasks out of a slot and place them again relative to the wheel time
+static void TTDelay_wheel_cascade(TTDelay_t* tt, uint16_t list) {
+    TT_TASK_INDEX_TYPE entry = tt->wheel_head[list];
+    tt->wheel_head[list] = 0;
+    tt->wheel_used[list / TT_WHEEL_SLOTS] &= ~((uint64_t)1 << (list % TT_WHEEL_SLOTS));
+    while (entry){
+        TT_TASK_INDEX_TYPE next = tt->wheel_next[entry - 1];
+        TTDelay_engine_wait(tt, entry - 1);
+        entry = next;
+    }
+}
+
+/* the lowest used slot of the lowest used level holds the task that is due
+ * next: everything on a higher level differs from the wheel time in a higher
+ * bit group and is due later. only that slot has to be looked at. */
+static TT_TASK_INDEX_TYPE TTDelay_engine_earliest(TTDelay_t* tt) {
+    TT_TASK_INDEX_TYPE earliest = TT_TASK_COUNT_MAX + 1;
+    TT_TASK_INDEX_TYPE entry    = tt->wheel_head[TT_WHEEL_OVERFLOW_LIST];
+    if (tt->ready_count)
+        return tt->ready[0];
+    for (uint8_t level = 0 ; level < TT_WHEEL_LEVELS ; level++){
+        if (tt->wheel_used[level]){
+            entry = tt->wheel_head[level * TT_WHEEL_SLOTS + TTDelay_ctz64(tt->wheel_used[level])];
+            break;
+        }
+    }
+    for ( ; entry ; entry = tt->wheel_next[entry - 1]){
+        if ((earliest > TT_TASK_COUNT_MAX) || TTDelay_task_earlier(tt, entry - 1, earliest))
+            earliest = entry - 1;
+    }
+    return earliest;
+}
+
+static void TTDelay_engine_collect_due(TTDelay_t* tt, TT_TIMER_TYPE previous_time) {
+    TT_TIMER_TYPE old_time = tt->wheel_time;
+
+    // timer overflow: overflown next execute times are valid now and due tasks
+    // might not be due anymore. place every task again (O(n), rare)
+    if (tt->current_time < previous_time){
+        for (uint16_t list = 0 ; list <= TT_WHEEL_OVERFLOW_LIST ; list++)
+            tt->wheel_head[list] = 0;
+        for (uint8_t level = 0 ; level < TT_WHEEL_LEVELS ; level++)
+            tt->wheel_used[level] = 0;
+        tt->ready_count = 0;
+#if TT_READY_BITMAP
+        TTDelay_level_clear(tt);
+#endif
+        tt->wheel_time  = tt->current_time;
+        for (TT_TASK_INDEX_TYPE i = 0 ; i < tt->task_count ; i++){
+            if ((TT_HOT(tt, i, fRunning))
+            || (tt->task[i].uiFlags & (TT_TASK_SUSPENDED | TT_TASK_DELETED)))
+                continue;
+            TT_HOT(tt, i, uiNextExecuteOverflow) = 0;
+            TTDelay_engine_insert(tt, i);
+        }
+        return;
+    }
+    if (tt->current_time == old_time)
+        return;
+
+    // empty all slots the wheel time passed, lowest level first. cascaded tasks
+    // always end up in slots ahead of the new wheel time.
+    tt->wheel_time = tt->current_time;
+    for (uint8_t level = 0 ; level < TT_WHEEL_LEVELS ; level++){
+        uint8_t       shift  = TT_WHEEL_BITS * level;
+        TT_TIMER_TYPE from   = old_time >> shift;
+        TT_TIMER_TYPE to     = tt->current_time >> shift;
+        uint64_t      passed;
+        if (from == to)
+            break;
+        if (to - from >= TT_WHEEL_SLOTS){
+            passed = ~(uint64_t)0;
+        } else {
+            // slots from+1 ... to, rotated as this may wrap around the end of the level
+            uint8_t first = (from + 1) & (TT_WHEEL_SLOTS - 1);
+            passed = ((uint64_t)1 << (to - from)) - 1;
+            if (first)
+                passed = (passed << first) | (passed >> (TT_WHEEL_SLOTS - first));
+        }
+        passed &= tt->wheel_used[level];
+        while (passed){
+            uint8_t slot = TTDelay_ctz64(passed);
+            passed &= passed - 1;
+            TTDelay_wheel_cascade(tt, level * TT_WHEEL_SLOTS + slot);
+        }
+    }
+}
+#endif
+#endif
+
+
+// the update asked for by TTDelay_cpu_usage_monitor(), done by the thread that
+// owns the instance when the monitor has returned
+static void TTDelay_cpu_usage_update(TTDelay_t* tt, TTDelay_task_t* task) {
+    if (!(task->uiFlags & TT_TASK_CPU_UPDATE))
+        return;
+    task->uiFlags &= ~TT_TASK_CPU_UPDATE;
+    TTDelay_calculate_cpu_usage_r(tt);
+#if TT_ADMISSION_CONTROL
+    // the longest measured execution times may have grown
+    if (TTDelay_check_schedulable_r(tt) != TT_OK){
+        TT_ADMISSION_HOOK(tt, tt->admission.iFailedTask);
+    }
+#endif
+    TTDelay_reset_time_running_r(tt);
+}
+
+// the slot of a deleted task is reused by the next TTDelay_create_task_r(tt)
+static void TTDelay_task_free(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TT_HOT(tt, index, fDue)        = 0;
+    tt->task[index].uiFlags     = TT_TASK_DELETED;
+    tt->task[index].timeRunning = 0;
+    tt->free_slot[tt->free_count++] = index;
+}
+
+/* ticks until the next task is due, 0 if a task is due right now and
+ * TT_IDLE_FOREVER if no task is waiting. reads TT_TIMER_FUNC. */
+TT_TIMER_TYPE TTDelay_get_remaining_idle_time_r(TTDelay_t* tt) {
+    TT_TIMER_TYPE      now   = TT_TIMER_FUNC;
+    TT_TASK_INDEX_TYPE index = TTDelay_engine_earliest(tt);
+
+#if TT_TASK_EVENTS
+    if (tt->event_summary)
+        return 0;
+#endif
+#if TT_TASK_COMMANDS
+    // the commands may make a task due
+    if (TT_ATOMIC_LOAD(&tt->command_tail) != tt->command_head)
+        return 0;
+#endif
+    if (index > TT_TASK_COUNT_MAX)
+        return TT_IDLE_FOREVER;
+    // the timer overflowed since the last run, TTDelay_run_r() has to sort that out first
+    if (now < tt->current_time)
+        return 0;
+    if ((!TT_HOT(tt, index, uiNextExecuteOverflow)) && (now >= TT_HOT(tt, index, uiTimeNextExecute)))
+        return 0;
+    // also right for an overflown next execute time, the difference wraps around
+    return TT_HOT(tt, index, uiTimeNextExecute) - now;
+}
+
+TT_TIMER_TYPE TTDelay_get_next_schedule_time_r(TTDelay_t* tt, int index){
+    return TT_HOT(tt, index, uiTimeNextExecute);
+}
+
+
+int TTDelay_get_task_count_r(TTDelay_t* tt) {
+    return tt->task_count - tt->free_count;
+}
+
+void TTDelay_set_idle_tick_count_r(TTDelay_t* tt, TT_TIMER_TYPE uiTickCount){
+    tt->uiCpuIdleCycleTickCount = uiTickCount;
+}
+
+void TTDelay_set_ttsys_tick_count_r(TTDelay_t* tt, TT_TIMER_TYPE uiTickCount){
+    tt->uiCpuTtsysCycleTickCount = uiTickCount;
+}
+
+#if TT_CPU_USAGE_FLOAT
+float TTDelay_get_idle_time_percentage_r(TTDelay_t* tt) {
+    return tt->cpu_usage.rIdleUsage; 
+}
+
+float TTDelay_get_ttsys_time_percentage_r(TTDelay_t* tt) {
+    return tt->cpu_usage.rTtsysUsage; 
+}
+#endif
+
+uint32_t TTDelay_get_idle_time_q16_r(TTDelay_t* tt) {
+    return tt->cpu_usage.uiIdleUsage;
+}
+
+uint32_t TTDelay_get_ttsys_time_q16_r(TTDelay_t* tt) {
+    return tt->cpu_usage.uiTtsysUsage;
+}
+
+/* with TT_LAYOUT_SPLIT the scheduling fields of the returned task are a copy,
+ * refreshed by every call (kept in the unused hot fields of task[]). writing
+ * them has no effect on the schedule */
+TTDelay_task_t* TTDelay_get_task_r(TTDelay_t* tt, int index){
+    if (!TTDelay_task_exists(tt, index))
+        return (TTDelay_task_t*)0;
+#if TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    tt->task[index].uiTimeNextExecute     = tt->hot.uiTimeNextExecute[index];
+    tt->task[index].uiNextExecuteOverflow = tt->hot.uiNextExecuteOverflow[index];
+    tt->task[index].uiCurrentPriority     = tt->hot.uiCurrentPriority[index];
+    tt->task[index].fDue                  = tt->hot.fDue[index];
+    tt->task[index].fRunning              = tt->hot.fRunning[index];
+#endif
+    return &tt->task[index];
+}
+
+int TTDelay_is_due_r(TTDelay_t* tt, int index){
+    // if task exists, return due status
+    if ((index >= 0) && (index < tt->task_count))
+        return TT_HOT(tt, index, fDue);
+    return 0;
+}
+
+TT_TASK_INDEX_TYPE TTDelay_get_next_scheduled_r(TTDelay_t* tt) {
+    return tt->highest_priority_index;
+}
+
+void* TTDelay_get_task_input_param_pointer_r(TTDelay_t* tt, int index){
+    if ((index >= 0) && (index < tt->task_count)){
+        return TT_CONST(tt, index, pvFuncParameterIn);
+    }
+    return (void*)0;
+}
+
+void* TTDelay_get_task_output_param_pointer_r(TTDelay_t* tt, int index){
+    if ((index >= 0) && (index < tt->task_count))
+        return TT_CONST(tt, index, pvFuncParameterOut);
+    return (void*)0;
+}
+
+int TTDelay_get_task_scheduled_count_r(TTDelay_t* tt) {
+    return tt->task_scheduled_count;
+}
+
+// share of uiTicks in Q16, uiTicks >> shift times uiScale fits into 32 bit
+static uint32_t TTDelay_cpu_share(TT_CPU_TICK_TYPE uiTicks, uint8_t shift, uint32_t uiScale) {
+    return ((uint32_t)(uiTicks >> shift) * uiScale) >> 16;
+}
+
+/* integer only: the total is shifted below 2^16, so one 32 bit division gives
+ * the scale for all values and the rest are 32 bit multiplications. the values
+ * are rounded down, 100 % may read as TT_CPU_USAGE_ONE - 1. */
+void TTDelay_calculate_cpu_usage_r(TTDelay_t* tt) {
+    TTDelay_task_t*  task        = (TTDelay_task_t*)tt->task;
+    TT_CPU_TICK_TYPE uiTotalTime = tt->uiCpuIdleCycleTickCount + tt->uiCpuTtsysCycleTickCount;
+    uint8_t          shift       = 0;
+    uint32_t         uiScale;
+
+    for (int i = 0 ; i < tt->task_count ; i++, task++){
+        uiTotalTime += task->timeRunning;
+    }
+    if (!uiTotalTime)
+        return;
+    while ((uiTotalTime >> shift) >= ((TT_CPU_TICK_TYPE)1 << 16))
+        shift++;
+    uiScale = 0xFFFFFFFFu / (uint32_t)(uiTotalTime >> shift);
+
+    task = (TTDelay_task_t*)tt->task;
+    for (int i = 0 ; i < tt->task_count ; i++, task++){
+        tt->cpu_usage.uiTaskUsage[i] = TTDelay_cpu_share(task->timeRunning, shift, uiScale);
+    }
+    tt->cpu_usage.uiIdleUsage  = TTDelay_cpu_share(tt->uiCpuIdleCycleTickCount,  shift, uiScale);
+    tt->cpu_usage.uiTtsysUsage = TTDelay_cpu_share(tt->uiCpuTtsysCycleTickCount, shift, uiScale);
+
+#if TT_CPU_USAGE_FLOAT
+    // float view, multiplications only
+    for (int i = 0 ; i < tt->task_count ; i++){
+        tt->cpu_usage.rTaskUsage[i] = tt->cpu_usage.uiTaskUsage[i] * (1.0f / TT_CPU_USAGE_ONE);
+        tt->task[i].rCpuUsage       = tt->cpu_usage.rTaskUsage[i];
+    }
+    tt->cpu_usage.rIdleUsage  = tt->cpu_usage.uiIdleUsage  * (1.0f / TT_CPU_USAGE_ONE);
+    tt->cpu_usage.rTtsysUsage = tt->cpu_usage.uiTtsysUsage * (1.0f / TT_CPU_USAGE_ONE);
+#endif
+#if TT_EXEC_HISTOGRAM
+    // execution times of the interval, the histograms are cleared afterwards
+    for (int i = 0 ; i < tt->task_count ; i++){
+        tt->cpu_usage.uiTaskExecP50[i] = TTDelay_get_exec_percentile_r(tt, i, 500);
+        tt->cpu_usage.uiTaskExecP99[i] = TTDelay_get_exec_percentile_r(tt, i, 990);
+        tt->cpu_usage.uiTaskExecMax[i] = tt->histogram[i].uiMax;
+    }
+#endif
+}
+
+void TTDelay_reset_time_running_r(TTDelay_t* tt) {
+    TTDelay_task_t* task = (TTDelay_task_t*)tt->task;
+    for (int i = 0 ; i < tt->task_count ; i++, task++){
+        task->timeRunning = 0;
+    }
+    tt->uiCpuIdleCycleTickCount  = 0;
+    tt->uiCpuTtsysCycleTickCount = 0;
+#if TT_EXEC_HISTOGRAM
+    TTDelay_reset_exec_histogram_r(tt);
+#endif
+}
+
+#if TT_ADMISSION_CONTROL
+// execution time the analysis assumes, in TT_READ_RST_TICK_FUNC ticks
+static uint64_t TTDelay_wcet(TTDelay_t* tt, int index) {
+    TTDelay_task_t* task = &tt->task[index];
+    return (task->uiWcet > task->uiLongestExecuteDuration) ? task->uiWcet : task->uiLongestExecuteDuration;
+}
+
+// periodic tasks are analysed, all others may only block them
+static int TTDelay_admission_periodic(TTDelay_t* tt, int index) {
+    return (tt->task[index].uiFlags & TT_TASK_IS_PERIODIC) && TT_CONST(tt, index, uiPeriod);
+}
+
+// relative deadline in TT_READ_RST_TICK_FUNC ticks, at most the period
+static uint64_t TTDelay_admission_deadline(TTDelay_t* tt, int index) {
+    TTDelay_task_t* task = &tt->task[index];
+    TT_TIMER_TYPE   uiPeriod   = TT_CONST(tt, index, uiPeriod);
+    TT_TIMER_TYPE   uiDeadline = (task->uiDeadline && (task->uiDeadline < uiPeriod)) ? task->uiDeadline : uiPeriod;
+    return (uint64_t)uiDeadline * TT_CPU_TICKS_PER_TIMER_TICK;
+}
+
+#if TT_SCHEDULING_POLICY != TT_POLICY_EDF
+/* non preemptive response time analysis: task index waits for the longest task
+ * that goes after it (it may just have started) and for every release of a task
+ * that goes before it until it starts. aging is not taken into account. */
+static int TTDelay_response_time_ok(TTDelay_t* tt, int index) {
+    uint64_t uiBlocking = 0, uiStart = 0, uiNext;
+    uint64_t uiWcet     = TTDelay_wcet(tt, index);
+    uint64_t uiDeadline = TTDelay_admission_deadline(tt, index);
+    uint8_t  prio       = TT_CONST(tt, index, uiInitialPriority);
+
+    for (int j = 0 ; j < tt->task_count ; j++){
+        if ((j == index) || (tt->task[j].uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED)))
+            continue;
+        // same order as TTDelay_due_before(): lower priority value, then lower index
+        if (TTDelay_admission_periodic(tt, j) && ((TT_CONST(tt, j, uiInitialPriority) < prio)
+        || ((TT_CONST(tt, j, uiInitialPriority) == prio) && (j < index))))
+            continue;
+        if (TTDelay_wcet(tt, j) > uiBlocking)
+            uiBlocking = TTDelay_wcet(tt, j);
+    }
+    for ( ; ; uiStart = uiNext){
+        uiNext = uiBlocking;
+        for (int j = 0 ; j < tt->task_count ; j++){
+            if ((j == index) || (tt->task[j].uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED))
+            || !TTDelay_admission_periodic(tt, j))
+                continue;
+            if ((TT_CONST(tt, j, uiInitialPriority) < prio) || ((TT_CONST(tt, j, uiInitialPriority) == prio) && (j < index)))
+                uiNext += (uiStart / ((uint64_t)TT_CONST(tt, j, uiPeriod) * TT_CPU_TICKS_PER_TIMER_TICK) + 1) * TTDelay_wcet(tt, j);
+        }
+        if (uiNext + uiWcet > uiDeadline)
+            return 0;
+        if (uiNext == uiStart)
+            return 1;
+    }
+}
+#endif
+
+/* checks if every periodic task that is neither suspended nor deleted meets its
+ * deadline with the worst case execution times. tasks are not preempted, so any
+ * task may block another one for its execution time.
+ * TT_POLICY_PRIORITY: response time analysis in the order of the priorities.
+ * TT_POLICY_EDF: density test, the sum of all WCET / deadline plus the longest
+ * other task / deadline of the task has to stay below 1 for every task.
+ * the result is kept in tt->admission. returns TT_OK or TT_ERROR_NOT_SCHEDULABLE */
+int TTDelay_check_schedulable_r(TTDelay_t* tt) {
+    uint64_t uiUtilization = 0;
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    uint64_t uiDensity = 0;
+#endif
+
+    tt->admission.iFailedTask = -1;
+    for (int i = 0 ; i < tt->task_count ; i++){
+        if ((tt->task[i].uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED)) || !TTDelay_admission_periodic(tt, i))
+            continue;
+        uiUtilization += (TTDelay_wcet(tt, i) << 16) / ((uint64_t)TT_CONST(tt, i, uiPeriod) * TT_CPU_TICKS_PER_TIMER_TICK);
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+        // rounded up, the test must not pass because of the rounding
+        uiDensity += ((TTDelay_wcet(tt, i) << 16) + TTDelay_admission_deadline(tt, i) - 1) / TTDelay_admission_deadline(tt, i);
+#endif
+    }
+    tt->admission.uiUtilization = (uiUtilization > 0xFFFFFFFF) ? 0xFFFFFFFF : (uint32_t)uiUtilization;
+
+    for (int i = 0 ; i < tt->task_count ; i++){
+        if ((tt->task[i].uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED)) || !TTDelay_admission_periodic(tt, i))
+            continue;
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+        uint64_t uiBlocking = 0;
+        for (int j = 0 ; j < tt->task_count ; j++){
+            if ((j != i) && !(tt->task[j].uiFlags & (TT_TASK_DELETED | TT_TASK_SUSPENDED)) && (TTDelay_wcet(tt, j) > uiBlocking))
+                uiBlocking = TTDelay_wcet(tt, j);
+        }
+        if (uiDensity + ((uiBlocking << 16) + TTDelay_admission_deadline(tt, i) - 1) / TTDelay_admission_deadline(tt, i) > TT_CPU_USAGE_ONE){
+#else
+        if (!TTDelay_response_time_ok(tt, i)){
+#endif
+            tt->admission.iFailedTask = i;
+            return TT_ERROR_NOT_SCHEDULABLE;
+        }
+    }
+    return TT_OK;
+}
+
+#ifndef TT_STATIC_TASKS
+// checks the task set after index was created, see TT_ADMISSION_CONTROL
+static int TTDelay_admit(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    if (TTDelay_check_schedulable_r(tt) == TT_OK)
+        return TT_OK;
+    TT_ADMISSION_HOOK(tt, tt->admission.iFailedTask);
+#if TT_ADMISSION_CONTROL == TT_ADMISSION_REJECT
+    TTDelay_delete_task_r(tt, index);
+    return TT_ERROR_NOT_SCHEDULABLE;
+#else
+    return TT_OK;
+#endif
+}
+#endif
+
+TTDelay_admission_t* TTDelay_get_admission_pointer_r(TTDelay_t* tt) {
+    return &tt->admission;
+}
+#endif
+
+#if TT_EXEC_HISTOGRAM || TT_LATENESS_STATS
+/* bucket b < TT_HISTOGRAM_SUB holds the time b. above that there are
+ * TT_HISTOGRAM_SUB buckets per power of two, picked by the bits below the
+ * highest set bit. */
+static uint8_t TTDelay_histogram_bucket(TT_TIMER_TYPE uiTime) {
+    uint8_t  exponent;
+    uint32_t bucket;
+
+    if (uiTime < TT_HISTOGRAM_SUB)
+        return (uint8_t)uiTime;
+    exponent = TT_LOG2(uiTime);
+    bucket   = (uint32_t)(exponent - TT_HISTOGRAM_SUB_BITS + 1) * TT_HISTOGRAM_SUB
+             + ((uiTime >> (exponent - TT_HISTOGRAM_SUB_BITS)) & (TT_HISTOGRAM_SUB - 1));
+    return (bucket < TT_HISTOGRAM_BUCKETS) ? (uint8_t)bucket : TT_HISTOGRAM_BUCKETS - 1;
+}
+
+// longest time counted in a bucket
+static TT_TIMER_TYPE TTDelay_histogram_upper(uint8_t bucket) {
+    uint8_t shift;
+
+    if (bucket < TT_HISTOGRAM_SUB)
+        return bucket;
+    shift = bucket / TT_HISTOGRAM_SUB - 1;
+    return (((TT_TIMER_TYPE)(TT_HISTOGRAM_SUB + bucket % TT_HISTOGRAM_SUB) + 1) << shift) - 1;
+}
+
+static void TTDelay_histogram_add(TTDelay_histogram_t* histogram, TT_TIMER_TYPE uiTime) {
+    histogram->uiCount[TTDelay_histogram_bucket(uiTime)]++;
+    histogram->uiSamples++;
+    if (uiTime > histogram->uiMax)
+        histogram->uiMax = uiTime;
+}
+
+/* time in ticks that uiPermille / 1000 of the samples did not exceed (500: median,
+ * 990: p99, 1000: max). the upper end of the bucket is returned, so the value is
+ * at most 1 / TT_HISTOGRAM_SUB too high. 0 without samples. */
+static TT_TIMER_TYPE TTDelay_histogram_percentile(TTDelay_histogram_t* histogram, uint16_t uiPermille) {
+    uint64_t rank;
+    uint32_t count = 0;
+
+    if (!histogram || !histogram->uiSamples)
+        return 0;
+    if (uiPermille > 1000)
+        uiPermille = 1000;
+    rank = ((uint64_t)histogram->uiSamples * uiPermille + 999) / 1000;
+    if (!rank)
+        rank = 1;
+    for (uint8_t bucket = 0 ; bucket < TT_HISTOGRAM_BUCKETS ; bucket++){
+        count += histogram->uiCount[bucket];
+        if (count >= rank){
+            TT_TIMER_TYPE upper = TTDelay_histogram_upper(bucket);
+            // the last bucket has no upper end, never report more than was seen
+            if ((bucket == TT_HISTOGRAM_BUCKETS - 1) || (upper > histogram->uiMax))
+                return histogram->uiMax;
+            return upper;
+        }
+    }
+    return histogram->uiMax;
+}
+#endif
+
+#if TT_EXEC_HISTOGRAM
+static void TTDelay_histogram_clear(TTDelay_histogram_t* histogram) {
+    *histogram = (TTDelay_histogram_t){0};
+}
+
+// execution time percentile of a task since the last reset, see TTDelay_histogram_percentile()
+TT_TIMER_TYPE TTDelay_get_exec_percentile_r(TTDelay_t* tt, int index, uint16_t uiPermille) {
+    return TTDelay_histogram_percentile(TTDelay_get_exec_histogram_r(tt, index), uiPermille);
+}
+
+TTDelay_histogram_t* TTDelay_get_exec_histogram_r(TTDelay_t* tt, int index) {
+    if (TTDelay_task_exists(tt, index))
+        return &tt->histogram[index];
+    return (TTDelay_histogram_t*)0;
+}
+
+// called by TTDelay_reset_time_running_r(tt), so it follows TT_CPU_LOAD_UPDATE_INTERVAL
+void TTDelay_reset_exec_histogram_r(TTDelay_t* tt) {
+    for (int i = 0 ; i < tt->task_count ; i++){
+        TTDelay_histogram_clear(&tt->histogram[i]);
+    }
+}
+#endif
+
+#if TT_LATENESS_STATS
+/* called when a task is started. a task started before its next execute time
+ * (TTDelay_run_task() on a task that is not due) counts as not late. a periodic
+ * task that ran before missed a period if the next one has started already. */
+static void TTDelay_lateness_add(TTDelay_t* tt, TT_TASK_INDEX_TYPE index) {
+    TTDelay_lateness_t* lateness = &tt->lateness[index];
+    TTDelay_task_t*     task     = &tt->task[index];
+    TT_TIMER_TYPE       uiLate   = 0;
+
+    if ((!TT_HOT(tt, index, uiNextExecuteOverflow)) && (tt->current_time >= TT_HOT(tt, index, uiTimeNextExecute)))
+        uiLate = tt->current_time - TT_HOT(tt, index, uiTimeNextExecute);
+    if ((!lateness->histogram.uiSamples) || (uiLate < lateness->uiMin))
+        lateness->uiMin = uiLate;
+    lateness->uiSum += uiLate;
+    TTDelay_histogram_add(&lateness->histogram, uiLate);
+    if ((task->uiFlags & TT_TASK_IS_PERIODIC) && (task->uiFlags & TT_TASK_EVER_RUN)
+    && TT_CONST(tt, index, uiPeriod) && (uiLate >= TT_CONST(tt, index, uiPeriod)))
+        lateness->uiMissedPeriods++;
+}
+
+static void TTDelay_lateness_clear(TTDelay_lateness_t* lateness) {
+    *lateness = (TTDelay_lateness_t){0};
+}
+
+TTDelay_lateness_t* TTDelay_get_lateness_pointer_r(TTDelay_t* tt, int index) {
+    if (TTDelay_task_exists(tt, index))
+        return &tt->lateness[index];
+    return (TTDelay_lateness_t*)0;
+}
+
+TT_TIMER_TYPE TTDelay_get_lateness_avg_r(TTDelay_t* tt, int index) {
+    TTDelay_lateness_t* lateness = TTDelay_get_lateness_pointer_r(tt, index);
+    if (!lateness || !lateness->histogram.uiSamples)
+        return 0;
+    return (TT_TIMER_TYPE)(lateness->uiSum / lateness->histogram.uiSamples);
+}
+
+TT_TIMER_TYPE TTDelay_get_lateness_percentile_r(TTDelay_t* tt, int index, uint16_t uiPermille) {
+    TTDelay_lateness_t* lateness = TTDelay_get_lateness_pointer_r(tt, index);
+    if (!lateness)
+        return 0;
+    return TTDelay_histogram_percentile(&lateness->histogram, uiPermille);
+}
+
+void TTDelay_reset_lateness_r(TTDelay_t* tt) {
+    for (int i = 0 ; i < tt->task_count ; i++){
+        TTDelay_lateness_clear(&tt->lateness[i]);
+    }
+}
+#endif
+
+#if TT_TRACE
+/* adds an event to the ring of tt, the oldest one is overwritten when it is
+ * full. only the thread running the tasks of tt may record events, it can be
+ * called by the application with uiType TT_TRACE_USER and above. */
+void TTDelay_trace_r(TTDelay_t* tt, uint8_t uiType, uint16_t uiTask, uint32_t uiArg) {
+    uint32_t               count = tt->trace_count;
+    TTDelay_trace_event_t* event = &tt->trace[count & (TT_TRACE_SIZE - 1)];
+    event->uiTicks  = tt->trace_ticks;
+    event->uiTime   = tt->current_time;
+    event->uiArg    = uiArg;
+    event->uiTask   = uiTask;
+    event->uiType   = uiType;
+    TT_TRACE_PUBLISH(tt->trace_count, count + 1);
+}
+
+/* copies the recorded events, oldest first, to events and fills the header for
+ * a capture file (header followed by the events). does not stop the recording:
+ * events overwritten while they were copied are dropped and counted as lost,
+ * so is the oldest one of a full ring, its slot is written next.
+ * returns the number of events copied. */
+int TTDelay_trace_read_r(TTDelay_t* tt, TTDelay_trace_header_t* header, TTDelay_trace_event_t* events, int iMaxCount) {
+    uint32_t count = TT_TRACE_COUNT(tt->trace_count);
+    uint32_t first = (count > TT_TRACE_SIZE) ? count - TT_TRACE_SIZE : 0;
+    uint32_t n, valid;
+
+    if (iMaxCount < 0)
+        iMaxCount = 0;
+    if (count - first > (uint32_t)iMaxCount)
+        first = count - iMaxCount;
+    for (n = 0 ; first + n != count ; n++){
+        events[n] = tt->trace[(first + n) & (TT_TRACE_SIZE - 1)];
+    }
+    // the writer may be filling the slot of event count + 1 - TT_TRACE_SIZE already
+    count = TT_TRACE_COUNT(tt->trace_count);
+    valid = (count + 1 > TT_TRACE_SIZE) ? count + 1 - TT_TRACE_SIZE : 0;
+    if (valid > first){
+        uint32_t drop = (valid - first < n) ? valid - first : n;
+        for (uint32_t i = drop ; i < n ; i++){
+            events[i - drop] = events[i];
+        }
+        n     -= drop;
+        first += drop;
+    }
+
+    header->acMagic[0]  = TT_TRACE_MAGIC[0];
+    header->acMagic[1]  = TT_TRACE_MAGIC[1];
+    header->acMagic[2]  = TT_TRACE_MAGIC[2];
+    header->acMagic[3]  = TT_TRACE_MAGIC[3];
+    header->uiVersion   = TT_TRACE_VERSION;
+    header->uiEventSize = sizeof(TTDelay_trace_event_t);
+    header->uiTimerBits = sizeof(TT_TIMER_TYPE) * 8;
+    header->uiCount     = n;
+    header->uiLost      = first;
+    return (int)n;
+}
+
+/* drops all recorded events, the trace clock keeps running */
+void TTDelay_trace_clear_r(TTDelay_t* tt) {
+    TT_TRACE_PUBLISH(tt->trace_count, 0);
+}
+#endif
+
+TTDelay_cpu_usage_TypDef* TTDelay_get_cpu_usage_pointer_r(TTDelay_t* tt) {
+    return &tt->cpu_usage;
+}
+
+/* the instance that is running the current task. Outside of a task this is the
+ * default instance (or the last one that ran a task on this thread). */
+TTDelay_t* TTDelay_get_current_instance(void) {
+    return ttCurrent;
+}
+
+/* the index of the task that is running, to be used inside of a task function */
+int TTDelay_get_current_task(void) {
+    return ttCurrentTask;
+}
+
+#if TT_TASK_EVENTS
+int TTDelay_notify(int index) {
+    return TTDelay_notify_r(&ttSystem, index);
+}
+#endif
+
+#if TT_TASK_COMMANDS
+int TTDelay_post_command(int index, uint8_t uiType, TT_TIMER_TYPE uiValue) {
+    return TTDelay_post_command_r(&ttSystem, index, uiType, uiValue);
+}
+#endif
+
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+void TTDelay_set_wake_hook(void (*fn)(void* context), void* context) {
+    TTDelay_set_wake_hook_r(&ttSystem, fn, context);
+}
+#endif
+
+#if TT_SCHEDULE_TABLE
+int TTDelay_table_generate(TTDelay_slot_t* slot, int iMaxSlots, TT_TIMER_TYPE* puiHyperperiod) {
+    return TTDelay_table_generate_r(&ttSystem, slot, iMaxSlots, puiHyperperiod);
+}
+
+int TTDelay_table_start(TTDelay_table_t* table, const TTDelay_slot_t* slot, int iCount, TT_TIMER_TYPE uiHyperperiod) {
+    return TTDelay_table_start_r(&ttSystem, table, slot, iCount, uiHyperperiod);
+}
+
+int TTDelay_run_table(TTDelay_table_t* table) {
+    return TTDelay_run_table_r(&ttSystem, table);
+}
+#endif
+
+/* where the coroutine of the running task continues, see TT_CO_BEGIN() */
+uint16_t* TTDelay_get_resume_pointer(void) {
+    return &ttCurrent->task[ttCurrentTask].uiResumePoint;
+}
+
+
+/*******************************************************************************
+* D E F A U L T   I N S T A N C E
+*******************************************************************************/
+void TTDelay_reset(void) {
+    TTDelay_reset_r(&ttSystem);
+}
+
+#ifndef TT_STATIC_TASKS
+int TTDelay_create_task(void (*func ), void* input_param, void* output_param, uint8_t priority){
+    return TTDelay_create_task_r(&ttSystem, func, input_param, output_param, priority);
+}
+
+int TTDelay_create_task_periodic(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod){
+    return TTDelay_create_task_periodic_r(&ttSystem, func, input_param, output_param, priority, uiPeriod);
+}
+
+int TTDelay_create_task_deadline(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiDeadline){
+    return TTDelay_create_task_deadline_r(&ttSystem, func, input_param, output_param, priority, uiPeriod, uiDeadline);
+}
+
+#if TT_ADMISSION_CONTROL
+int TTDelay_create_task_wcet(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiWcet){
+    return TTDelay_create_task_wcet_r(&ttSystem, func, input_param, output_param, priority, uiPeriod, uiWcet);
+}
+#endif
+#endif
+
+#if TT_ADMISSION_CONTROL
+int TTDelay_check_schedulable(void) {
+    return TTDelay_check_schedulable_r(&ttSystem);
+}
+
+TTDelay_admission_t* TTDelay_get_admission_pointer(void) {
+    return TTDelay_get_admission_pointer_r(&ttSystem);
+}
+#endif
+
+int TTDelay_run(void) {
+    return TTDelay_run_r(&ttSystem);
+}
+
+int TTDelay_run_batch(int iMaxTasks, TT_TIMER_TYPE uiMaxTime) {
+    return TTDelay_run_batch_r(&ttSystem, iMaxTasks, uiMaxTime);
+}
+
+int TTDelay_delete_task(int index) {
+    return TTDelay_delete_task_r(&ttSystem, index);
+}
+
+int TTDelay_suspend_task(int index) {
+    return TTDelay_suspend_task_r(&ttSystem, index);
+}
+
+int TTDelay_resume_task(int index) {
+    return TTDelay_resume_task_r(&ttSystem, index);
+}
+
+int TTDelay_get_last_created(void) {
+    return TTDelay_get_last_created_r(&ttSystem);
+}
+
+void TTDelay_find_due_tasks(void) {
+    TTDelay_find_due_tasks_r(&ttSystem);
+}
+
+void TTDelay_adjust_priority(void) {
+    TTDelay_adjust_priority_r(&ttSystem);
+}
+
+void TTDelay_run_task(int index){
+    TTDelay_run_task_r(&ttSystem, index);
+}
+
+TT_TIMER_TYPE TTDelay_get_remaining_idle_time(void) {
+    return TTDelay_get_remaining_idle_time_r(&ttSystem);
+}
+
+TT_TIMER_TYPE TTDelay_get_next_schedule_time(int index){
+    return TTDelay_get_next_schedule_time_r(&ttSystem, index);
+}
+
+int TTDelay_get_task_count(void) {
+    return TTDelay_get_task_count_r(&ttSystem);
+}
+
+void TTDelay_set_idle_tick_count(TT_TIMER_TYPE uiTickCount){
+    TTDelay_set_idle_tick_count_r(&ttSystem, uiTickCount);
+}
+
+void TTDelay_set_ttsys_tick_count(TT_TIMER_TYPE uiTickCount){
+    TTDelay_set_ttsys_tick_count_r(&ttSystem, uiTickCount);
+}
+
+#if TT_CPU_USAGE_FLOAT
+float TTDelay_get_idle_time_percentage(void) {
+    return TTDelay_get_idle_time_percentage_r(&ttSystem);
+}
+
+float TTDelay_get_ttsys_time_percentage(void) {
+    return TTDelay_get_ttsys_time_percentage_r(&ttSystem);
+}
+#endif
+
+uint32_t TTDelay_get_idle_time_q16(void) {
+    return TTDelay_get_idle_time_q16_r(&ttSystem);
+}
+
+uint32_t TTDelay_get_ttsys_time_q16(void) {
+    return TTDelay_get_ttsys_time_q16_r(&ttSystem);
+}
+
+TTDelay_task_t* TTDelay_get_task(int index){
+    return TTDelay_get_task_r(&ttSystem, index);
+}
+
+int TTDelay_is_due(int index){
+    return TTDelay_is_due_r(&ttSystem, index);
+}
+
+TT_TASK_INDEX_TYPE TTDelay_get_next_scheduled(void) {
+    return TTDelay_get_next_scheduled_r(&ttSystem);
+}
+
+void* TTDelay_get_task_input_param_pointer(int index){
+    return TTDelay_get_task_input_param_pointer_r(&ttSystem, index);
+}
+
+void* TTDelay_get_task_output_param_pointer(int index){
+    return TTDelay_get_task_output_param_pointer_r(&ttSystem, index);
+}
+
+int TTDelay_get_task_scheduled_count(void) {
+    return TTDelay_get_task_scheduled_count_r(&ttSystem);
+}
+
+void TTDelay_calculate_cpu_usage(void) {
+    TTDelay_calculate_cpu_usage_r(&ttSystem);
+}
+
+void TTDelay_reset_time_running(void) {
+    TTDelay_reset_time_running_r(&ttSystem);
+}
+
+TTDelay_cpu_usage_TypDef* TTDelay_get_cpu_usage_pointer(void) {
+    return TTDelay_get_cpu_usage_pointer_r(&ttSystem);
+}
+
+#if TT_EXEC_HISTOGRAM
+TT_TIMER_TYPE TTDelay_get_exec_percentile(int index, uint16_t uiPermille) {
+    return TTDelay_get_exec_percentile_r(&ttSystem, index, uiPermille);
+}
+
+void TTDelay_reset_exec_histogram(void) {
+    TTDelay_reset_exec_histogram_r(&ttSystem);
+}
+#endif
+
+#if TT_LATENESS_STATS
+TTDelay_lateness_t* TTDelay_get_lateness_pointer(int index) {
+    return TTDelay_get_lateness_pointer_r(&ttSystem, index);
+}
+
+TT_TIMER_TYPE TTDelay_get_lateness_avg(int index) {
+    return TTDelay_get_lateness_avg_r(&ttSystem, index);
+}
+
+TT_TIMER_TYPE TTDelay_get_lateness_percentile(int index, uint16_t uiPermille) {
+    return TTDelay_get_lateness_percentile_r(&ttSystem, index, uiPermille);
+}
+
+void TTDelay_reset_lateness(void) {
+    TTDelay_reset_lateness_r(&ttSystem);
+}
+#endif
+
+#if TT_TRACE
+void TTDelay_trace(uint8_t uiType, uint16_t uiTask, uint32_t uiArg) {
+    TTDelay_trace_r(&ttSystem, uiType, uiTask, uiArg);
+}
+
+int TTDelay_trace_read(TTDelay_trace_header_t* header, TTDelay_trace_event_t* events, int iMaxCount) {
+    return TTDelay_trace_read_r(&ttSystem, header, events, iMaxCount);
+}
+
+void TTDelay_trace_clear(void) {
+    TTDelay_trace_clear_r(&ttSystem);
 }
+#endif
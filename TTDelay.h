@@ -21,7 +21,94 @@
 #define TT_TASK_EVER_RUN       0x01
 #define TT_TASK_IS_PERIODIC    0x02
 #define TT_TIMER_OVERFLOW      0x04
-#define TT_TASK_ACTIVE         0x08
+#define TT_TASK_CPU_UPDATE     0x08    // set by TTDelay_cpu_usage_monitor
+#define TT_TASK_SUSPENDED      0x10
+#define TT_TASK_DELETED        0x20
+#define TT_TASK_WAIT_EVENT     0x40
+#define TT_TASK_NOTIFIED       0x80
+
+// TTDelay_wait_event() without timeout
+#define TT_WAIT_FOREVER        (-1)
+
+// commands for TTDelay_post_command(), uiValue is
+#define TT_COMMAND_FROM_NOW    1    // ticks from when the command is applied, next execute time
+#define TT_COMMAND_PERIOD      2    // new period, 0: not periodic
+#define TT_COMMAND_PRIORITY    3    // new initial and current priority
+#define TT_COMMAND_SUSPEND     4    // -
+#define TT_COMMAND_RESUME      5    // -
+
+// scheduler engines, select one through TT_SCHEDULER_ENGINE in TTDelay_config.h
+#define TT_ENGINE_LINEAR       0
+#define TT_ENGINE_HEAP         1
+#define TT_ENGINE_WHEEL        2
+
+// which due task runs first, select one through TT_SCHEDULING_POLICY in TTDelay_config.h
+#define TT_POLICY_PRIORITY     0
+#define TT_POLICY_EDF          1
+
+// admission control for periodic tasks, see TT_ADMISSION_CONTROL in TTDelay_config.h
+#define TT_ADMISSION_OFF       0
+#define TT_ADMISSION_WARN      1
+#define TT_ADMISSION_REJECT    2
+
+// task table layouts, select one through TT_TASK_LAYOUT in TTDelay_config.h
+#define TT_LAYOUT_AOS          0
+#define TT_LAYOUT_SPLIT        1
+
+// CPU usage values are Q16 fractions of the measured time, this one is 100 %
+#define TT_CPU_USAGE_ONE       ((uint32_t)1 << 16)
+
+// trace event types (TT_TRACE), arguments see TTDelay_trace_event_t.
+// TT_TRACE_USER and above are free for TTDelay_trace_r() calls of the application
+#define TT_TRACE_TASK_START    1
+#define TT_TRACE_TASK_END      2
+#define TT_TRACE_FROM_NOW      3
+#define TT_TRACE_FROM_LAST     4
+#define TT_TRACE_SET_FUNCTION  5
+#define TT_TRACE_AGING         6
+#define TT_TRACE_IDLE          7
+#define TT_TRACE_USER          16
+// task index of events that do not belong to a task
+#define TT_TRACE_NO_TASK       0xFFFF
+// first bytes of a trace capture, see TTDelay_trace_header_t
+#define TT_TRACE_MAGIC         "TTTR"
+#define TT_TRACE_VERSION       1
+
+/* stackless coroutines: a task function written between TT_CO_BEGIN() and
+ * TT_CO_END() returns at every TT_CO_YIELD/WAIT and continues right after it on
+ * the next run of the task (switch on the line saved in uiResumePoint, no stack
+ * is kept). Local variables are lost on return, keep the state in the task
+ * parameters or in static variables. No switch statement may span a yield.
+ * Use a task that is not periodic, the waits set the next execute time.
+ * TT_CO_END() starts over with the next run, delete or suspend the task to stop.
+ * TTDelay_set_next_function() starts the new function at its beginning, return
+ * right after it instead of yielding. */
+#define TT_CO_BEGIN()           { uint16_t* puiCoResume = TTDelay_get_resume_pointer(); \
+                                  switch (*puiCoResume) { case 0:
+#define TT_CO_END()             } *puiCoResume = 0; }
+// run again as soon as the scheduler picks it, other due tasks may run first
+#define TT_CO_YIELD()           do { *puiCoResume = __LINE__; return; case __LINE__:; } while (0)
+// continue 'ticks' timer ticks after the start of the current run
+#define TT_CO_WAIT(ticks)       do { TTDelay_from_now(ticks); TT_CO_YIELD(); } while (0)
+// continue once 'cond' is true, checked every 'poll' ticks (0: every run)
+#define TT_CO_WAIT_UNTIL(cond, poll) \
+                                do { if (!(cond)) { *puiCoResume = __LINE__; TTDelay_from_now(poll); return; \
+                                     case __LINE__: if (!(cond)) { TTDelay_from_now(poll); return; } } } while (0)
+
+// returned by TTDelay_get_remaining_idle_time() if no task is waiting
+#define TT_IDLE_FOREVER        ((TT_TIMER_TYPE)~(TT_TIMER_TYPE)0)
+
+// timing wheel: bits of the timer value per level, one uint64_t bitmap per level
+#define TT_WHEEL_BITS           6
+#define TT_WHEEL_SLOTS          (1 << TT_WHEEL_BITS)
+#define TT_WHEEL_LEVELS         ((sizeof(TT_TIMER_TYPE) * 8 + TT_WHEEL_BITS - 1) / TT_WHEEL_BITS)
+#define TT_WHEEL_OVERFLOW_LIST  (TT_WHEEL_LEVELS * TT_WHEEL_SLOTS)
+
+#if TT_INSTANCE_ALIGNMENT
+    #define TT_INSTANCE_ALIGN   __attribute__((aligned(TT_INSTANCE_ALIGNMENT)))
+#else
+    #define TT_INSTANCE_ALIGN
+#endif
 
 #ifdef TT_MONITOR_CPU_LOAD
     #define GET_RST_TICK(x)    x = TT_READ_RST_TICK_FUNC
@@ -33,34 +120,264 @@
 * Types and Typedefs
 *******************************************************************************/
 typedef struct TTDelay_task_t {
-    TT_TIMER_TYPE   timeRunning;
+    TT_CPU_TICK_TYPE timeRunning;
+#if TT_CPU_USAGE_FLOAT
     float           rCpuUsage;
+#endif
     TT_TIMER_TYPE   uiTimeNextExecute;
     TT_TIMER_TYPE   uiTimeLastExecute;
+#ifndef TT_STATIC_TASKS
     TT_TIMER_TYPE   uiPeriod; 
+#endif
     TT_TIMER_TYPE   uiLongestExecuteDuration; 
+    TT_TIMER_TYPE   uiDeadline;         // relative to uiTimeNextExecute (TT_POLICY_EDF)
+#if TT_ADMISSION_CONTROL
+    TT_TIMER_TYPE   uiWcet;             // declared worst case execution time (TT_READ_RST_TICK_FUNC ticks)
+#endif
     uint8_t         uiNextExecuteOverflow;
+#ifndef TT_STATIC_TASKS
     uint8_t         uiInitialPriority;
+#endif
     uint8_t         uiCurrentPriority;
     uint8_t         uiFlags;
     uint8_t         fDue;
+    uint8_t         fRunning;
+    uint16_t        uiResumePoint;      // line a stackless coroutine continues at (TT_CO_BEGIN)
+#if TT_TASK_COMMANDS
+    // commands posted while the task was running, applied when it ends
+    uint8_t         uiHeldCommands;     // bit 1 << TT_COMMAND_... per held command
+    uint8_t         uiHeldPriority;
+    TT_TIMER_TYPE   uiHeldFromNow;
+    TT_TIMER_TYPE   uiHeldPeriod;
+#endif
+#ifndef TT_STATIC_TASKS
     void            (*func )(void*, void*);
     void *          pvFuncParameterIn;
     void *          pvFuncParameterOut;
+#endif
 } TTDelay_task_t;
 
+#ifdef TT_STATIC_TASKS
+/* the constant part of a task declared by TT_STATIC_TASKS, kept in ROM */
+typedef struct TTDelay_task_rom_t {
+    void            (*func )(void*, void*);
+    void *          pvFuncParameterIn;
+    void *          pvFuncParameterOut;
+    TT_TIMER_TYPE   uiPeriod;
+    uint8_t         uiInitialPriority;
+} TTDelay_task_rom_t;
+
+#define TT_STATIC_TASK_INDEX(name, func, in, out, priority, period)    TT_TASK_##name,
+#define TT_STATIC_TASK_ROM(name, func, in, out, priority, period) \
+    { (void (*)(void*, void*))(func), (void*)(in), (void*)(out), (period), (priority) },
+enum { TT_STATIC_TASKS(TT_STATIC_TASK_INDEX) TT_STATIC_TASK_COUNT };
+
+// the table itself, to be expanded once by the application where the task
+// functions and parameters are declared: TT_STATIC_TASK_TABLE();
+#define TT_STATIC_TASK_TABLE() \
+    const TTDelay_task_rom_t ttStaticTask[ TT_STATIC_TASK_COUNT ] = { TT_STATIC_TASKS(TT_STATIC_TASK_ROM) }
+extern const TTDelay_task_rom_t ttStaticTask[ TT_STATIC_TASK_COUNT ];
+#endif
+
+/* scheduling keys of all tasks in parallel arrays (TT_LAYOUT_SPLIT).
+ * the due search reads only these. the same fields in task[] are not used,
+ * they only hold the copy returned by TTDelay_get_task_r(). */
+typedef struct TTDelay_hot_t {
+    TT_TIMER_TYPE   uiTimeNextExecute    [ TT_TASK_COUNT_MAX ];
+    uint8_t         uiNextExecuteOverflow[ TT_TASK_COUNT_MAX ];
+    uint8_t         uiCurrentPriority    [ TT_TASK_COUNT_MAX ];
+    uint8_t         fDue                 [ TT_TASK_COUNT_MAX ];
+    uint8_t         fRunning             [ TT_TASK_COUNT_MAX ];
+} TTDelay_hot_t;
+
+#if TT_EXEC_HISTOGRAM || TT_LATENESS_STATS
+// logarithmic histogram of times in ticks, see TT_HISTOGRAM_SUB_BITS
+typedef struct TTDelay_histogram_t {
+    uint32_t        uiCount[ TT_HISTOGRAM_BUCKETS ];
+    uint32_t        uiSamples;
+    TT_TIMER_TYPE   uiMax;
+} TTDelay_histogram_t;
+#endif
+
+#if TT_LATENESS_STATS
+// start of a task run minus its next execute time, since the last reset
+typedef struct TTDelay_lateness_t {
+    TTDelay_histogram_t histogram;      // also holds the run count and the max
+    TT_TIMER_TYPE   uiMin;
+    uint64_t        uiSum;
+    uint32_t        uiMissedPeriods;    // periodic: started a period or more late
+} TTDelay_lateness_t;
+#endif
+
+#if TT_TRACE
+/* one trace event, 16 bytes with the same layout on every target so a capture
+ * can be read on the host (tools/tt_trace2json.c). uiArg depends on uiType:
+ * TASK_START: next execute time the task was due at, TASK_END: execution ticks,
+ * FROM_NOW/FROM_LAST: new next execute time, SET_FUNCTION: the new function
+ * (lower 32 bit), AGING: new priority, IDLE: idle ticks. */
+typedef struct TTDelay_trace_event_t {
+    uint32_t        uiTicks;            // sum of all TT_READ_RST_TICK_FUNC ticks
+    uint32_t        uiTime;             // TT_TIMER_FUNC time of the current run
+    uint32_t        uiArg;
+    uint16_t        uiTask;             // task index or TT_TRACE_NO_TASK
+    uint8_t         uiType;             // TT_TRACE_...
+    uint8_t         uiReserved;
+} TTDelay_trace_event_t;
+
+// written in front of the events of a capture (see TTDelay_trace_read_r)
+typedef struct TTDelay_trace_header_t {
+    char            acMagic[4];         // TT_TRACE_MAGIC
+    uint16_t        uiVersion;          // TT_TRACE_VERSION
+    uint8_t         uiEventSize;        // sizeof(TTDelay_trace_event_t)
+    uint8_t         uiTimerBits;        // bits of TT_TIMER_TYPE, uiTime wraps there
+    uint32_t        uiCount;            // events following the header
+    uint32_t        uiLost;             // events recorded before the first one, not included
+} TTDelay_trace_header_t;
+#endif
+
+#if TT_TASK_COMMANDS
+/* slot of the command queue. uiSequence tells whose turn it is, it is stored
+ * relative to the slot number so a zeroed queue is empty. */
+typedef struct TTDelay_command_t {
+    volatile uint32_t uiSequence;
+    TT_TIMER_TYPE   uiValue;
+    TT_TASK_INDEX_TYPE uiTask;
+    uint8_t         uiType;             // TT_COMMAND_...
+} TTDelay_command_t;
+#endif
+
+#if TT_SCHEDULE_TABLE
+// one task start of a schedule table
+typedef struct TTDelay_slot_t {
+    TT_TIMER_TYPE   uiOffset;           // ticks after the start of the hyperperiod
+    TT_TASK_INDEX_TYPE uiTask;
+} TTDelay_slot_t;
+
+/* a schedule table being run by TTDelay_run_table_r(), set up by
+ * TTDelay_table_start_r(). the slots are ordered by offset and may be const. */
+typedef struct TTDelay_table_t {
+    const TTDelay_slot_t* slot;
+    uint32_t        uiCount;
+    uint32_t        uiNext;             // next slot to run
+    TT_TIMER_TYPE   uiHyperperiod;
+    TT_TIMER_TYPE   uiStart;            // TT_TIMER_FUNC at the start of the current hyperperiod
+} TTDelay_table_t;
+#endif
+
+#if TT_ADMISSION_CONTROL
+// result of the last schedulability check (TTDelay_check_schedulable_r)
+typedef struct TTDelay_admission_t {
+    uint32_t        uiUtilization;      // periodic tasks, WCET / period as Q16 (TT_CPU_USAGE_ONE)
+    int             iFailedTask;        // first task that may miss its deadline, -1: none
+} TTDelay_admission_t;
+#endif
+
 typedef struct TTDelay_cpu_usage_TypDef {
+#if TT_CPU_USAGE_FLOAT
     float rTaskUsage[TT_TASK_COUNT_MAX];
     float rIdleUsage;
     float rTtsysUsage;
+#endif
+    uint32_t uiTaskUsage[TT_TASK_COUNT_MAX];        // Q16, see TT_CPU_USAGE_ONE
+    uint32_t uiIdleUsage;
+    uint32_t uiTtsysUsage;
+#if TT_EXEC_HISTOGRAM
+    // execution times of the last TT_CPU_LOAD_UPDATE_INTERVAL, in ticks
+    TT_TIMER_TYPE uiTaskExecP50[TT_TASK_COUNT_MAX];
+    TT_TIMER_TYPE uiTaskExecP99[TT_TASK_COUNT_MAX];
+    TT_TIMER_TYPE uiTaskExecMax[TT_TASK_COUNT_MAX];
+#endif
 } TTDelay_cpu_usage_TypDef;
 
+/* a complete TTDelay system (instance). All functions ending in _r take a
+ * pointer to one of these, the functions without _r use a default instance.
+ * An instance has to be zeroed (static storage or TTDelay_reset_r()) before use. */
+typedef struct TTDelay_t {
+    TT_TASK_INDEX_TYPE current_task_index;
+    TT_TASK_INDEX_TYPE task_count;
+    uint8_t         highest_priority_value;
+    TT_TASK_INDEX_TYPE highest_priority_index;
+    TT_TASK_INDEX_TYPE task_scheduled_count;
+    TT_TIMER_TYPE   current_time;
+    TT_TIMER_TYPE   last_run_time;
+    TT_CPU_TICK_TYPE uiCpuTtsysCycleTickCount;
+    TT_CPU_TICK_TYPE uiCpuIdleCycleTickCount;
+#if TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    TTDelay_hot_t   hot;
+#endif
+#if TT_SCAN_MASK
+    uint32_t        due_mask[ (TT_TASK_COUNT_MAX + 31) / 32 ]; // one bit per due task
+#endif
+#if TT_TASK_EVENTS
+    volatile uint32_t event_summary;                    // bit w % 32: event_pending[w] may be set
+    volatile uint32_t event_pending[ (TT_TASK_COUNT_MAX + 31) / 32 ]; // one bit per notified task
+#endif
+#if TT_TASK_COMMANDS
+    volatile uint32_t command_tail;                     // next slot to post to, any thread
+    uint32_t        command_head;                       // next slot to apply, scheduler only
+    TTDelay_command_t command[ TT_COMMAND_QUEUE_SIZE ];
+#endif
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+    void            (*wake_hook)(void* context);        // see TTDelay_set_wake_hook_r()
+    void*           wake_context;
+#endif
+    TTDelay_task_t  task [ TT_TASK_COUNT_MAX ];        // hot fields only a copy if split
+    TTDelay_cpu_usage_TypDef cpu_usage;
+#if TT_EXEC_HISTOGRAM
+    TTDelay_histogram_t histogram[ TT_TASK_COUNT_MAX ];
+#endif
+#if TT_LATENESS_STATS
+    TTDelay_lateness_t lateness[ TT_TASK_COUNT_MAX ];
+#endif
+#if TT_ADMISSION_CONTROL
+    TTDelay_admission_t admission;
+#endif
+#if TT_TRACE
+    uint32_t        trace_ticks;                        // clock of the trace events
+    volatile uint32_t trace_count;                      // events ever recorded
+    TTDelay_trace_event_t trace[ TT_TRACE_SIZE ];
+#endif
+    TT_TASK_INDEX_TYPE batch   [ TT_TASK_COUNT_MAX ];   // due tasks of TTDelay_run_batch_r(tt)
+    TT_TASK_INDEX_TYPE last_created_index;
+    TT_TASK_INDEX_TYPE free_count;
+    TT_TASK_INDEX_TYPE free_slot[ TT_TASK_COUNT_MAX ];  // deleted tasks, reused first
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+    TT_TASK_INDEX_TYPE active_count;
+    TT_TASK_INDEX_TYPE active  [ TT_TASK_COUNT_MAX ];   // tasks not suspended or deleted
+#endif
+#if TT_SCHEDULER_ENGINE != TT_ENGINE_LINEAR
+    TT_TASK_INDEX_TYPE ready_count;
+    TT_TASK_INDEX_TYPE ready   [ TT_TASK_COUNT_MAX ];   // due tasks, unordered
+    TT_TASK_INDEX_TYPE position[ TT_TASK_COUNT_MAX ];   // index into heap[] or ready[] (see fDue)
+#endif
+#if TT_READY_BITMAP
+    uint8_t            ready_summary;                   // bit w: ready_levels[w] not 0
+    uint32_t           ready_levels[ 8 ];               // bit p: a due task has priority p
+    TT_TASK_INDEX_TYPE level_head[ 256 ];               // FIFO list per priority (index + 1)
+    TT_TASK_INDEX_TYPE level_tail[ 256 ];
+    TT_TASK_INDEX_TYPE level_next[ TT_TASK_COUNT_MAX ];
+    TT_TASK_INDEX_TYPE level_prev[ TT_TASK_COUNT_MAX ];
+#endif
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_HEAP
+    TT_TASK_INDEX_TYPE heap_count;
+    TT_TASK_INDEX_TYPE heap    [ TT_TASK_COUNT_MAX ];   // waiting tasks, earliest first
+#elif TT_SCHEDULER_ENGINE == TT_ENGINE_WHEEL
+    TT_TIMER_TYPE      wheel_time;                       // time the wheel was last moved to
+    uint64_t           wheel_used[ TT_WHEEL_LEVELS ];    // one bit per non empty slot
+    TT_TASK_INDEX_TYPE wheel_head[ TT_WHEEL_OVERFLOW_LIST + 1 ];
+    TT_TASK_INDEX_TYPE wheel_next[ TT_TASK_COUNT_MAX ];
+    TT_TASK_INDEX_TYPE wheel_prev[ TT_TASK_COUNT_MAX ];
+    uint16_t           wheel_list[ TT_TASK_COUNT_MAX ];  // slot the task is waiting in
+#endif
+} TT_INSTANCE_ALIGN TTDelay_t;
+
 enum {
     TT_OK,
     TT_NOK,
     TT_ERROR_TOO_MANY_TASKS,
     TT_RETURN_COUNT,
-    TT_MORE_TASKS_SCHEDULED
+    TT_MORE_TASKS_SCHEDULED,
+    TT_ERROR_NOT_SCHEDULABLE
 };
 
 /*******************************************************************************
@@ -71,30 +388,168 @@ enum {
 * Function Prototypes
 *******************************************************************************/
 // public functions to be used
+#ifndef TT_STATIC_TASKS
 int  TTDelay_create_task(void (*func ), void* input_param, void* output_param, uint8_t priority);
 int  TTDelay_create_task_periodic(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod);
+int  TTDelay_create_task_deadline(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiDeadline);
+#if TT_ADMISSION_CONTROL
+int  TTDelay_create_task_wcet(void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiWcet);
+#endif
+int  TTDelay_set_next_function(void (*func ));
+#endif
+#if TT_ADMISSION_CONTROL
+int  TTDelay_check_schedulable(void);
+TTDelay_admission_t* TTDelay_get_admission_pointer(void);
+#endif
 int  TTDelay_run(void);
+int  TTDelay_run_batch(int iMaxTasks, TT_TIMER_TYPE uiMaxTime);
 void TTDelay_from_last(int delay);
 void TTDelay_from_now (int delay);
-int  TTDelay_set_next_function(void (*func ));
+int  TTDelay_delete_task (int index);
+int  TTDelay_suspend_task(int index);
+int  TTDelay_resume_task (int index);
+int  TTDelay_get_last_created(void);
+int  TTDelay_get_current_task(void);
+uint16_t* TTDelay_get_resume_pointer(void);  // TT_CO_BEGIN()
+#if TT_TASK_EVENTS
+int  TTDelay_notify(int index);
+void TTDelay_wait_event(int timeout);
+int  TTDelay_was_notified(void);
+#endif
+#if TT_TASK_COMMANDS
+int  TTDelay_post_command(int index, uint8_t uiType, TT_TIMER_TYPE uiValue);
+#endif
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+void TTDelay_set_wake_hook(void (*fn)(void* context), void* context);
+#endif
+#if TT_SCHEDULE_TABLE
+int  TTDelay_table_generate(TTDelay_slot_t* slot, int iMaxSlots, TT_TIMER_TYPE* puiHyperperiod);
+int  TTDelay_table_start(TTDelay_table_t* table, const TTDelay_slot_t* slot, int iCount, TT_TIMER_TYPE uiHyperperiod);
+int  TTDelay_run_table(TTDelay_table_t* table);
+#endif
+TT_TIMER_TYPE TTDelay_get_remaining_idle_time(void);
 void TTDelay_cpu_usage_monitor(void* in, void* out); // runs as a seperate task, both arguments can be NULL
 
+// same as above, working on the given instance instead of the default one.
+// TTDelay_from_last/from_now/set_next_function/cpu_usage_monitor always act on
+// the instance that is running the task.
+#ifndef TT_STATIC_TASKS
+int  TTDelay_create_task_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority);
+int  TTDelay_create_task_periodic_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod);
+int  TTDelay_create_task_deadline_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiDeadline);
+#if TT_ADMISSION_CONTROL
+int  TTDelay_create_task_wcet_r(TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority, TT_TIMER_TYPE uiPeriod, TT_TIMER_TYPE uiWcet);
+#endif
+#endif
+#if TT_ADMISSION_CONTROL
+int  TTDelay_check_schedulable_r(TTDelay_t* tt);
+TTDelay_admission_t* TTDelay_get_admission_pointer_r(TTDelay_t* tt);
+#endif
+int  TTDelay_run_r(TTDelay_t* tt);
+int  TTDelay_run_batch_r(TTDelay_t* tt, int iMaxTasks, TT_TIMER_TYPE uiMaxTime);
+TT_TIMER_TYPE TTDelay_get_remaining_idle_time_r(TTDelay_t* tt);
+int  TTDelay_delete_task_r (TTDelay_t* tt, int index);
+int  TTDelay_suspend_task_r(TTDelay_t* tt, int index);
+int  TTDelay_resume_task_r (TTDelay_t* tt, int index);
+int  TTDelay_get_last_created_r(TTDelay_t* tt);
+#if TT_TASK_EVENTS
+int  TTDelay_notify_r(TTDelay_t* tt, int index);
+#endif
+#if TT_TASK_COMMANDS
+int  TTDelay_post_command_r(TTDelay_t* tt, int index, uint8_t uiType, TT_TIMER_TYPE uiValue);
+#endif
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+void TTDelay_set_wake_hook_r(TTDelay_t* tt, void (*fn)(void* context), void* context);
+#endif
+#if TT_SCHEDULE_TABLE
+int  TTDelay_table_generate_r(TTDelay_t* tt, TTDelay_slot_t* slot, int iMaxSlots, TT_TIMER_TYPE* puiHyperperiod);
+int  TTDelay_table_start_r(TTDelay_t* tt, TTDelay_table_t* table, const TTDelay_slot_t* slot, int iCount, TT_TIMER_TYPE uiHyperperiod);
+int  TTDelay_run_table_r(TTDelay_t* tt, TTDelay_table_t* table);
+#endif
+void TTDelay_reset_r(TTDelay_t* tt);
+TTDelay_t* TTDelay_get_current_instance(void);
+
 //functions for unit testing
 void    TTDelay_adjust_priority(void);
 void    TTDelay_reset(void);
 int     TTDelay_get_task_count(void);
-uint8_t TTDelay_get_next_scheduled(void);
+TT_TASK_INDEX_TYPE TTDelay_get_next_scheduled(void);
 TTDelay_task_t* TTDelay_get_task(int index);
 void    TTDelay_find_due_tasks(void);
 void    TTDelay_run_task(int index);
 int     TTDelay_is_due(int index);
 void*   TTDelay_get_task_output_param_pointer(int index);
 void*   TTDelay_get_task_input_param_pointer (int index);
-uint32_t TTDelay_get_next_schedule_time(int index);
+TT_TIMER_TYPE TTDelay_get_next_schedule_time(int index);
+#if TT_CPU_USAGE_FLOAT
 float   TTDelay_get_idle_time_percentage(void);
 float   TTDelay_get_ttsys_time_percentage(void);
-void    TTDelay_set_idle_tick_count(uint32_t uiTickCount);
-void    TTDelay_set_ttsys_tick_count(uint32_t uiTickCount);
+#endif
+uint32_t TTDelay_get_idle_time_q16(void);
+uint32_t TTDelay_get_ttsys_time_q16(void);
+void    TTDelay_set_idle_tick_count(TT_TIMER_TYPE uiTickCount);
+void    TTDelay_set_ttsys_tick_count(TT_TIMER_TYPE uiTickCount);
+void    TTDelay_calculate_cpu_usage(void);
+void    TTDelay_reset_time_running(void);
 TTDelay_cpu_usage_TypDef* TTDelay_get_cpu_usage_pointer(void);
+#if TT_EXEC_HISTOGRAM
+TT_TIMER_TYPE TTDelay_get_exec_percentile(int index, uint16_t uiPermille);
+void    TTDelay_reset_exec_histogram(void);
+#endif
+#if TT_LATENESS_STATS
+TTDelay_lateness_t* TTDelay_get_lateness_pointer(int index);
+TT_TIMER_TYPE TTDelay_get_lateness_avg(int index);
+TT_TIMER_TYPE TTDelay_get_lateness_percentile(int index, uint16_t uiPermille);
+void    TTDelay_reset_lateness(void);
+#endif
+#if TT_TRACE
+void    TTDelay_trace(uint8_t uiType, uint16_t uiTask, uint32_t uiArg);
+int     TTDelay_trace_read(TTDelay_trace_header_t* header, TTDelay_trace_event_t* events, int iMaxCount);
+void    TTDelay_trace_clear(void);
+#endif
+
+void    TTDelay_adjust_priority_r(TTDelay_t* tt);
+int     TTDelay_get_task_count_r(TTDelay_t* tt);
+TT_TASK_INDEX_TYPE TTDelay_get_next_scheduled_r(TTDelay_t* tt);
+TTDelay_task_t* TTDelay_get_task_r(TTDelay_t* tt, int index);
+void    TTDelay_find_due_tasks_r(TTDelay_t* tt);
+void    TTDelay_run_task_r(TTDelay_t* tt, int index);
+int     TTDelay_get_due_tasks_r(TTDelay_t* tt, TT_TASK_INDEX_TYPE* puiIndex, int iMaxCount);
+void    TTDelay_task_begin_r(TTDelay_t* tt, int index);
+void    TTDelay_task_execute_r(TTDelay_t* tt, int index);
+void    TTDelay_task_end_r(TTDelay_t* tt, int index, TT_TIMER_TYPE uiExecuteTime);
+void    TTDelay_task_cancel_r(TTDelay_t* tt, int index);
+int     TTDelay_is_due_r(TTDelay_t* tt, int index);
+void*   TTDelay_get_task_output_param_pointer_r(TTDelay_t* tt, int index);
+void*   TTDelay_get_task_input_param_pointer_r (TTDelay_t* tt, int index);
+TT_TIMER_TYPE TTDelay_get_next_schedule_time_r(TTDelay_t* tt, int index);
+int     TTDelay_get_task_scheduled_count_r(TTDelay_t* tt);
+#if TT_CPU_USAGE_FLOAT
+float   TTDelay_get_idle_time_percentage_r(TTDelay_t* tt);
+float   TTDelay_get_ttsys_time_percentage_r(TTDelay_t* tt);
+#endif
+uint32_t TTDelay_get_idle_time_q16_r(TTDelay_t* tt);
+uint32_t TTDelay_get_ttsys_time_q16_r(TTDelay_t* tt);
+void    TTDelay_set_idle_tick_count_r(TTDelay_t* tt, TT_TIMER_TYPE uiTickCount);
+void    TTDelay_set_ttsys_tick_count_r(TTDelay_t* tt, TT_TIMER_TYPE uiTickCount);
+void    TTDelay_calculate_cpu_usage_r(TTDelay_t* tt);
+void    TTDelay_reset_time_running_r(TTDelay_t* tt);
+TTDelay_cpu_usage_TypDef* TTDelay_get_cpu_usage_pointer_r(TTDelay_t* tt);
+#if TT_EXEC_HISTOGRAM
+TT_TIMER_TYPE TTDelay_get_exec_percentile_r(TTDelay_t* tt, int index, uint16_t uiPermille);
+TTDelay_histogram_t* TTDelay_get_exec_histogram_r(TTDelay_t* tt, int index);
+void    TTDelay_reset_exec_histogram_r(TTDelay_t* tt);
+#endif
+#if TT_LATENESS_STATS
+TTDelay_lateness_t* TTDelay_get_lateness_pointer_r(TTDelay_t* tt, int index);
+TT_TIMER_TYPE TTDelay_get_lateness_avg_r(TTDelay_t* tt, int index);
+TT_TIMER_TYPE TTDelay_get_lateness_percentile_r(TTDelay_t* tt, int index, uint16_t uiPermille);
+void    TTDelay_reset_lateness_r(TTDelay_t* tt);
+#endif
+#if TT_TRACE
+void    TTDelay_trace_r(TTDelay_t* tt, uint8_t uiType, uint16_t uiTask, uint32_t uiArg);
+int     TTDelay_trace_read_r(TTDelay_t* tt, TTDelay_trace_header_t* header, TTDelay_trace_event_t* events, int iMaxCount);
+void    TTDelay_trace_clear_r(TTDelay_t* tt);
+#endif
 
 #endif // _SIMPLE_SCHEDULER_H
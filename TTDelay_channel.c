@@ -0,0 +1,91 @@
+/* ******************************************************************************
+ * @file      TTDelay_channel.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * single producer / single consumer channels: fixed capacity rings of
+ * preallocated slots, passed by reference.
+ *
+ * @desription
+ * The producer gets a pointer to the next free slot with
+ * TTDelay_channel_reserve(), fills it and hands it over with
+ * TTDelay_channel_commit(). The consumer gets a pointer to the oldest slot with
+ * TTDelay_channel_peek() and gives it back with TTDelay_channel_release() once
+ * it is done with it. Nothing is copied. Each side writes only its own counter
+ * (uiTail / uiHead), so producer and consumer may be different threads or an
+ * interrupt and a task, as long as there is one of each per channel.
+ * With TT_TASK_EVENTS a consumer task bound by TTDelay_channel_bind() is
+ * notified on every commit and can wait with TTDelay_wait_event() instead of
+ * polling.
+ * *****************************************************************************/
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include "TTDelay_channel.h"
+
+/*******************************************************************************
+* F U N C T I O N S   U S E D   I N   U S E R   P R O G R A M
+*******************************************************************************/
+/* use pvSlots (uiCapacity slots of uiSlotSize bytes, uiCapacity a power of 2,
+ * e.g. an array of the message type) as an empty channel */
+int TTDelay_channel_init(TTDelay_channel_t* ch, void* pvSlots, uint32_t uiSlotSize, uint32_t uiCapacity){
+    if (!pvSlots || !uiSlotSize || !uiCapacity || (uiCapacity & (uiCapacity - 1)))
+        return TT_NOK;
+    ch->puiSlots      = (uint8_t*)pvSlots;
+    ch->uiSlotSize    = uiSlotSize;
+    ch->uiCapacity    = uiCapacity;
+    ch->uiHead        = 0;
+    ch->uiTail        = 0;
+#if TT_TASK_EVENTS
+    ch->ttConsumer    = 0;
+    ch->iConsumerTask = -1;
+#endif
+    return TT_OK;
+}
+
+#if TT_TASK_EVENTS
+/* notify task 'index' of tt whenever a slot is committed (TTDelay_notify_r) */
+void TTDelay_channel_bind(TTDelay_channel_t* ch, TTDelay_t* tt, int index){
+    ch->ttConsumer    = tt;
+    ch->iConsumerTask = index;
+}
+#endif
+
+/* producer: the next free slot, 0 if the channel is full. the same slot is
+ * returned until it is committed. */
+void* TTDelay_channel_reserve(TTDelay_channel_t* ch){
+    uint32_t tail = ch->uiTail;
+    if (tail - TT_ATOMIC_LOAD(&ch->uiHead) >= ch->uiCapacity)
+        return 0;
+    return ch->puiSlots + (tail & (ch->uiCapacity - 1)) * ch->uiSlotSize;
+}
+
+/* producer: hand the reserved slot to the consumer */
+void TTDelay_channel_commit(TTDelay_channel_t* ch){
+    TT_ATOMIC_STORE(&ch->uiTail, ch->uiTail + 1);
+#if TT_TASK_EVENTS
+    if (ch->ttConsumer)
+        TTDelay_notify_r(ch->ttConsumer, ch->iConsumerTask);
+#endif
+}
+
+/* consumer: the oldest committed slot, 0 if the channel is empty. the same
+ * slot is returned until it is released. */
+void* TTDelay_channel_peek(TTDelay_channel_t* ch){
+    uint32_t head = ch->uiHead;
+    if (TT_ATOMIC_LOAD(&ch->uiTail) == head)
+        return 0;
+    return ch->puiSlots + (head & (ch->uiCapacity - 1)) * ch->uiSlotSize;
+}
+
+/* consumer: the slot returned by TTDelay_channel_peek() may be reused */
+void TTDelay_channel_release(TTDelay_channel_t* ch){
+    TT_ATOMIC_STORE(&ch->uiHead, ch->uiHead + 1);
+}
+
+/* committed slots not released yet */
+uint32_t TTDelay_channel_count(TTDelay_channel_t* ch){
+    return TT_ATOMIC_LOAD(&ch->uiTail) - TT_ATOMIC_LOAD(&ch->uiHead);
+}
@@ -0,0 +1,47 @@
+/**
+ * @file      TTDelay_channel.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * optional single producer / single consumer channels between tasks: a ring of
+ * fixed size slots the producer fills in place and the consumer reads in place.
+ */
+
+#ifndef _TTDELAY_CHANNEL_H
+#define _TTDELAY_CHANNEL_H
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include "TTDelay.h"
+
+/*******************************************************************************
+* Types and Typedefs
+*******************************************************************************/
+typedef struct TTDelay_channel_t {
+    uint8_t*           puiSlots;        // uiCapacity slots of uiSlotSize bytes
+    uint32_t           uiSlotSize;
+    uint32_t           uiCapacity;      // power of 2
+    volatile uint32_t  uiHead;          // slots released, written by the consumer only
+    volatile uint32_t  uiTail;          // slots committed, written by the producer only
+#if TT_TASK_EVENTS
+    TTDelay_t*         ttConsumer;      // notified on commit, see TTDelay_channel_bind()
+    int                iConsumerTask;
+#endif
+} TTDelay_channel_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int      TTDelay_channel_init   (TTDelay_channel_t* ch, void* pvSlots, uint32_t uiSlotSize, uint32_t uiCapacity);
+#if TT_TASK_EVENTS
+void     TTDelay_channel_bind   (TTDelay_channel_t* ch, TTDelay_t* tt, int index);
+#endif
+void*    TTDelay_channel_reserve(TTDelay_channel_t* ch);
+void     TTDelay_channel_commit (TTDelay_channel_t* ch);
+void*    TTDelay_channel_peek   (TTDelay_channel_t* ch);
+void     TTDelay_channel_release(TTDelay_channel_t* ch);
+uint32_t TTDelay_channel_count  (TTDelay_channel_t* ch);
+
+#endif // _TTDELAY_CHANNEL_H
@@ -18,14 +18,78 @@
 // provide a function to read your current time/tick value (used for scheduling)
 #define TT_TIMER_FUNC          GetSysTick()
 // data type of counter register (so we can detect overflow correctly)
+#ifndef TT_TIMER_TYPE
 #define TT_TIMER_TYPE          uint32_t
+#endif
 
 // tiny scheduler reserves memory for TASK_COUNT_MAX tasks 
+// (the limits below may also be given on the compiler command line)
+#ifndef TT_TASK_COUNT_MAX
 #define TT_TASK_COUNT_MAX           7
+#endif
+// data type used for task indices, must be able to hold TT_TASK_COUNT_MAX + 1
+#ifndef TT_TASK_INDEX_TYPE
+#define TT_TASK_INDEX_TYPE          uint8_t
+#endif
+
+/* *****************************************************
+ *  SCHEDULER ENGINE
+ * ****************************************************/
+// how TTDelay finds the tasks that are due:
+// TT_ENGINE_LINEAR - check every task on each TTDelay_run() (smallest footprint)
+// TT_ENGINE_HEAP   - keep waiting tasks in a min-heap ordered by their next execute
+//                    time. finding due tasks is O(log n), a TTDelay_run() with
+//                    nothing due is O(1). needs 3 extra indices per task.
+// TT_ENGINE_WHEEL  - hierarchical timing wheel (64 slots per 6 bit of TT_TIMER_TYPE).
+//                    adding and expiring a task is O(1) amortized, long delays
+//                    cascade through the levels. needs 4 extra indices per task
+//                    and about 3 kB (32 bit timer) for the wheel itself.
+#ifndef TT_SCHEDULER_ENGINE
+#define TT_SCHEDULER_ENGINE         TT_ENGINE_LINEAR
+#endif
+
+// how the task table is stored in memory:
+// TT_LAYOUT_AOS   - one TTDelay_task_t per task (default)
+// TT_LAYOUT_SPLIT - the fields the due search reads (next execute time, overflow,
+//                   priority, due and running flag) are kept in dense parallel
+//                   arrays, statistics and callback data stay in task[]. faster
+//                   scans with many tasks, TTDelay_get_task() returns a copy of
+//                   the scheduling fields then. needs sizeof(TT_TIMER_TYPE) + 4
+//                   bytes more per task.
+#ifndef TT_TASK_LAYOUT
+#define TT_TASK_LAYOUT              TT_LAYOUT_AOS
+#endif
+
+// linear engine with TT_LAYOUT_SPLIT: build a bitmask of the due tasks with SIMD
+// compares (AVX2 with -mavx2, else SSE2 on x86, portable code on other targets)
+// and only look at the due tasks afterwards. 1: enable
+#ifndef TT_SCAN_MASK
+#define TT_SCAN_MASK                0
+#endif
+
+// heap and wheel engine: keep the due tasks in one list per priority level and a
+// bitmap of the used levels. the highest priority task is found in constant time
+// and aging moves a task to the next level, tasks of the same priority run in
+// the order they became due. needs 2 * 256 + 2 extra indices per task. 1: enable
+#ifndef TT_READY_BITMAP
+#define TT_READY_BITMAP             0
+#endif
+
+// which of the due tasks is run first:
+// TT_POLICY_PRIORITY - lowest priority value, with aging (see below)
+// TT_POLICY_EDF      - earliest deadline first. the deadline is the next execute
+//                      time plus uiDeadline of the task: the period for periodic
+//                      tasks, 0 for others or as given to TTDelay_create_task_deadline().
+//                      the priority decides a tie, there is no aging.
+#ifndef TT_SCHEDULING_POLICY
+#define TT_SCHEDULING_POLICY        TT_POLICY_PRIORITY
+#endif
 
 // to make sure low priority tasks dont starve, increase their priorioty whenever \
     they have been scheduled but not run
+#ifndef TT_ENABLE_TASK_AGING
 #define TT_ENABLE_TASK_AGING        1
+#endif
 
 // maximum allowed priority increase through aging (default: 0xFF)
 #define TT_PRIORITY_MAX_CHANGE      0xFF
@@ -34,14 +98,217 @@
 #define TT_PRIORITY_THRESHOLD       15
 
 
+/* *****************************************************
+ *  INSTANCES
+ * ****************************************************/
+// storage class of the pointer to the instance that runs the current task
+// (used by TTDelay_from_now and friends). set this to _Thread_local (or __thread)
+// when instances are run on several threads, leave it empty otherwise.
+#ifndef TT_THREAD_LOCAL
+#define TT_THREAD_LOCAL
+#endif
+// alignment of TTDelay_t in bytes. set to the cache line size (e.g. 64) so that
+// instances run by different threads do not share a cache line. 0: no alignment
+#ifndef TT_INSTANCE_ALIGNMENT
+#define TT_INSTANCE_ALIGNMENT       0
+#endif
+
+
+/* *****************************************************
+ *  EVENTS
+ * ****************************************************/
+// 1: tasks can be made due right away by TTDelay_notify(), from interrupts and
+// other threads, and can wait for that with TTDelay_wait_event()
+#ifndef TT_TASK_EVENTS
+#define TT_TASK_EVENTS              0
+#endif
+// atomic "*p |= v" and "take *p and set it to 0" on the uint32_t pending events.
+// the defaults use the GCC builtins, on parts without atomic read-modify-write
+// (e.g. Cortex-M0) define them with interrupts disabled
+#ifndef TT_ATOMIC_OR
+#define TT_ATOMIC_OR(p, v)          __atomic_fetch_or((p), (v), __ATOMIC_RELEASE)
+#endif
+#ifndef TT_ATOMIC_TAKE
+#define TT_ATOMIC_TAKE(p)           __atomic_exchange_n((p), 0, __ATOMIC_ACQUIRE)
+#endif
+
+
+/* *****************************************************
+ *  COMMANDS
+ * ****************************************************/
+// 1: other threads and interrupts can change the next execute time, period and
+// priority of a task through TTDelay_post_command(), applied by the next
+// search for due tasks
+#ifndef TT_TASK_COMMANDS
+#define TT_TASK_COMMANDS            0
+#endif
+// commands waiting at most, power of 2
+#ifndef TT_COMMAND_QUEUE_SIZE
+#define TT_COMMAND_QUEUE_SIZE       32
+#endif
+// atomics of the command queue and the channels (TTDelay_channel.c) on
+// uint32_t. the defaults use the GCC builtins, on parts without compare and
+// swap (e.g. Cortex-M0) define them with interrupts disabled
+#ifndef TT_ATOMIC_LOAD
+#define TT_ATOMIC_LOAD(p)           __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#endif
+#ifndef TT_ATOMIC_STORE
+#define TT_ATOMIC_STORE(p, v)       __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#endif
+// if *p equals *e set *p to v and return 1, else copy *p to *e and return 0
+#ifndef TT_ATOMIC_CAS
+#define TT_ATOMIC_CAS(p, e, v)      __atomic_compare_exchange_n((p), (e), (v), 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)
+#endif
+
+/* *****************************************************
+ *  SCHEDULE TABLE
+ * ****************************************************/
+// 1: periodic tasks can be run from a precomputed table of the hyperperiod
+// (TTDelay_table_generate, TTDelay_run_table) instead of TTDelay_run()
+#ifndef TT_SCHEDULE_TABLE
+#define TT_SCHEDULE_TABLE           0
+#endif
+
+/* *****************************************************
+ *  STATIC TASKS
+ * ****************************************************/
+// task set fixed at compile time, one X() per task:
+//     X(name, func, input_param, output_param, priority, period)
+// period 0: not periodic. func, the parameters, priority and period go into a
+// const table (ROM, TT_STATIC_TASK_TABLE), the instance keeps only the
+// scheduling state and starts with all tasks due. the index of a task is
+// TT_TASK_<name>. TTDelay_create_task and TTDelay_set_next_function are not
+// available then.
+/*
+#define TT_STATIC_TASKS(X) \
+    X(blink,  blink_task,  NULL, &led_state, 5, 100) \
+    X(sensor, sensor_task, NULL, &sample,    3, 10)
+*/
+
+/* *****************************************************
+ *  WORKER POOL (TTDelay_pool.c, needs pthreads)
+ * ****************************************************/
+// maximum number of worker threads per pool
+#ifndef TT_POOL_WORKERS_MAX
+#define TT_POOL_WORKERS_MAX         8
+#endif
+// free running counter the workers use to measure the execution time of a task
+// (TT_READ_RST_TICK_FUNC resets the counter and can not be shared by threads).
+// it has to count TT_READ_RST_TICK_FUNC ticks, like the execute times and the
+// CPU usage of tasks run by TTDelay_run(). there is no default, TTDelay_pool.c
+// does not build without it (TT_TIMER_FUNC has other units in general).
+
+
+/* *****************************************************
+ *  STACKFUL TASKS (TTDelay_fiber.c, needs ucontext and mmap)
+ * ****************************************************/
+// maximum number of stacks (fiber tasks alive at once) per pool
+#ifndef TT_FIBER_STACKS_MAX
+#define TT_FIBER_STACKS_MAX         16
+#endif
+// stack size used when TTDelay_fiber_pool_init() is given 0, rounded up to pages
+#ifndef TT_FIBER_STACK_SIZE
+#define TT_FIBER_STACK_SIZE         (64 * 1024)
+#endif
+// switch stacks with a few instructions instead of swapcontext(), which also
+// saves and restores the signal mask with system calls. x86-64 only, other
+// targets and 0 use ucontext
+#ifndef TT_FIBER_ASM_SWITCH
+#define TT_FIBER_ASM_SWITCH         1
+#endif
+
+
+/* *****************************************************
+ *  TICKLESS IDLE (TTDelay_sleep.c, needs pthreads)
+ * ****************************************************/
+// length of one TT_TIMER_FUNC tick in nanoseconds (default: 1 ms ticks). the
+// timer has to count CLOCK_MONOTONIC, e.g. TT_TIMER_FUNC TTDelay_sleep_ticks()
+#ifndef TT_TICK_NS
+#define TT_TICK_NS                  1000000
+#endif
+
+
 // TTDelay can monitor the CPU load caused by different tasks. uncomment this to enable
+// (TT_NO_CPU_MONITOR turns it off from the command line, see benchmark/Makefile)
+#ifndef TT_NO_CPU_MONITOR
 #define TT_MONITOR_CPU_LOAD
+#endif
 // provide a function to read and to reset the tick count.
 // this function is called at the start and end of each task function call.
 // make sure the function resets the timer (counter register) and returns 
 // the counter register value (from before the reset)
 #define TT_READ_RST_TICK_FUNC           ReadResetCpuLoadTick()
 #define TT_CPU_LOAD_UPDATE_INTERVAL     1000
+// data type the ticks of TT_READ_RST_TICK_FUNC are summed up in between two
+// usage calculations (64 bit does not overflow in practice)
+#ifndef TT_CPU_TICK_TYPE
+#define TT_CPU_TICK_TYPE                uint64_t
+#endif
+// the usage is calculated with integers only, as Q16 fraction (TT_CPU_USAGE_ONE is 100 %).
+// 1: also provide it as float (rTaskUsage, TTDelay_get_idle_time_percentage(), ...)
+// 0: no floating point at all, e.g. for parts without FPU
+#ifndef TT_CPU_USAGE_FLOAT
+#define TT_CPU_USAGE_FLOAT              1
+#endif
+
+// 1: count the execution time (ticks of TT_READ_RST_TICK_FUNC) of every task run
+// in a histogram with logarithmic buckets per task, see TTDelay_get_exec_percentile().
+// the histograms are cleared together with the CPU usage counters, so they cover
+// one TT_CPU_LOAD_UPDATE_INTERVAL when TTDelay_cpu_usage_monitor is used.
+#ifndef TT_EXEC_HISTOGRAM
+#define TT_EXEC_HISTOGRAM               0
+#endif
+// 2^TT_HISTOGRAM_SUB_BITS buckets per power of two (2: a bucket is at most 25 % wide)
+#ifndef TT_HISTOGRAM_SUB_BITS
+#define TT_HISTOGRAM_SUB_BITS           2
+#endif
+// buckets per task (max. 255). longer times are counted in the last bucket.
+// 64 buckets with 2 sub bits reach 2^17 ticks, 4 bytes RAM per bucket and task
+#ifndef TT_HISTOGRAM_BUCKETS
+#define TT_HISTOGRAM_BUCKETS            64
+#endif
+
+// 1: record how late every task is started compared to its next execute time
+// (TT_TIMER_FUNC ticks): min, average, max and a histogram (buckets as above),
+// plus the runs of periodic tasks that started one period or more late.
+// see TTDelay_get_lateness_pointer()
+#ifndef TT_LATENESS_STATS
+#define TT_LATENESS_STATS               0
+#endif
+
+// 1: record task start/end, rescheduling, aging and idle events in a ring buffer
+// per instance (16 bytes per event, a few stores each). the time stamps are the
+// summed up ticks of TT_READ_RST_TICK_FUNC and the TT_TIMER_FUNC time, read a
+// capture with TTDelay_trace_read() and convert it with tools/tt_trace2json.c.
+// events are recorded by the thread that runs the tasks, not with TTDelay_pool.c
+#ifndef TT_TRACE
+#define TT_TRACE                        0
+#endif
+// events kept in the ring, a power of two. older events are overwritten
+#ifndef TT_TRACE_SIZE
+#define TT_TRACE_SIZE                   256
+#endif
+
+// check if the periodic tasks can meet their deadlines (the period, or uiDeadline
+// with TT_POLICY_EDF) whenever one is created and on every run of
+// TTDelay_cpu_usage_monitor. the execution time of a task is the larger one of the
+// declared (TTDelay_create_task_wcet) and the longest measured one.
+// TT_ADMISSION_OFF    - no check
+// TT_ADMISSION_WARN   - create the task anyway and call TT_ADMISSION_HOOK
+// TT_ADMISSION_REJECT - also call TT_ADMISSION_HOOK, but delete the new task again
+//                       and return TT_ERROR_NOT_SCHEDULABLE
+#ifndef TT_ADMISSION_CONTROL
+#define TT_ADMISSION_CONTROL            TT_ADMISSION_OFF
+#endif
+// TT_READ_RST_TICK_FUNC ticks per TT_TIMER_FUNC tick (e.g. 72000 for a 72 MHz
+// counter and a 1 ms system tick)
+#ifndef TT_CPU_TICKS_PER_TIMER_TICK
+#define TT_CPU_TICKS_PER_TIMER_TICK     1
+#endif
+// called with the instance and the index of a task that may miss its deadline
+#ifndef TT_ADMISSION_HOOK
+#define TT_ADMISSION_HOOK(tt, index)
+#endif
 
 
 
@@ -0,0 +1,247 @@
+/* ******************************************************************************
+ * @file      TTDelay_fiber.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * stackful tasks for hosts: a task function that runs on a stack of its own
+ * and can wait in the middle of a deep call stack.
+ *
+ * @desription
+ * The stacks come from a pool that is mapped once by TTDelay_fiber_pool_init(),
+ * with an inaccessible guard page below every stack, so an overflow faults
+ * instead of overwriting the next stack. Pages are only committed when they
+ * are touched. To the scheduler a fiber is an ordinary task that is not
+ * periodic: its task function switches to the fiber stack, the fiber
+ * runs until it calls TTDelay_fiber_sleep() or returns, then the task function
+ * returns as usual. TTDelay_fiber_sleep() sets the next execute time with
+ * TTDelay_from_now(), so the fiber is resumed through uiTimeNextExecute like
+ * every other task. When the fiber function returns, the task deletes itself
+ * and the stack goes back to the pool. The stack of a fiber task deleted by
+ * somebody else (TTDelay_delete_task_r) goes back when the pool runs out of
+ * stacks, see TTDelay_fiber_reclaim().
+ * The switch saves the callee saved registers on the old stack and loads the
+ * stack pointer of the other side (x86-64, TT_FIBER_ASM_SWITCH), elsewhere
+ * swapcontext() is used.
+ * A fiber is resumed by the thread that runs its instance (TTDelay_run_r),
+ * fibers can not be used with the worker pool.
+ * *****************************************************************************/
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <sys/mman.h>
+#include <unistd.h>
+#include "TTDelay_fiber.h"
+
+/*******************************************************************************
+* Defines
+*******************************************************************************/
+#if !TT_FIBER_UCONTEXT
+// default MXCSR and x87 control word of a new fiber
+#define TT_FIBER_MXCSR          0x1F80
+#define TT_FIBER_FPU_CW         0x037F
+#endif
+
+/*******************************************************************************
+* Static Function Prototypes
+*******************************************************************************/
+static void TTDelay_fiber_task(void* in, void* out);
+static void TTDelay_fiber_entry(void);
+static void TTDelay_fiber_reclaim(TTDelay_fiber_pool_t* pool);
+#if !TT_FIBER_UCONTEXT
+void TTDelay_fiber_switch(void** ppvSaveStackPointer, void* pvStackPointer);
+
+/* saves rbp, rbx, r12..r15, MXCSR and the x87 control word on the current stack,
+ * stores the stack pointer in *ppvSaveStackPointer and continues on the stack
+ * pvStackPointer, which was saved the same way (or prepared by TTDelay_fiber_create) */
+__asm__(
+    ".text\n"
+    ".globl  TTDelay_fiber_switch\n"
+    ".hidden TTDelay_fiber_switch\n"
+    ".type   TTDelay_fiber_switch, @function\n"
+    "TTDelay_fiber_switch:\n"
+    "    pushq   %rbp\n"
+    "    pushq   %rbx\n"
+    "    pushq   %r12\n"
+    "    pushq   %r13\n"
+    "    pushq   %r14\n"
+    "    pushq   %r15\n"
+    "    subq    $8, %rsp\n"
+    "    stmxcsr (%rsp)\n"
+    "    fnstcw  4(%rsp)\n"
+    "    movq    %rsp, (%rdi)\n"
+    "    movq    %rsi, %rsp\n"
+    "    ldmxcsr (%rsp)\n"
+    "    fldcw   4(%rsp)\n"
+    "    addq    $8, %rsp\n"
+    "    popq    %r15\n"
+    "    popq    %r14\n"
+    "    popq    %r13\n"
+    "    popq    %r12\n"
+    "    popq    %rbx\n"
+    "    popq    %rbp\n"
+    "    ret\n"
+    ".size   TTDelay_fiber_switch, .-TTDelay_fiber_switch\n"
+);
+#endif
+
+/*******************************************************************************
+* Variables
+*******************************************************************************/
+// the fiber that is running, for TTDelay_fiber_sleep()
+static TT_THREAD_LOCAL TTDelay_fiber_t* ttFiber;
+
+/*******************************************************************************
+* F U N C T I O N S   U S E D   I N   U S E R   P R O G R A M
+*******************************************************************************/
+/* map iCount stacks of uiStackSize bytes (0: TT_FIBER_STACK_SIZE), each with a
+ * guard page below it. the memory is reserved here and committed on use. */
+int TTDelay_fiber_pool_init(TTDelay_fiber_pool_t* pool, int iCount, size_t uiStackSize){
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+
+    if ((iCount < 1) || (iCount > TT_FIBER_STACKS_MAX))
+        return TT_NOK;
+    if (!uiStackSize)
+        uiStackSize = TT_FIBER_STACK_SIZE;
+    pool->uiStackSize  = (uiStackSize + page - 1) & ~(page - 1);
+    pool->uiSlotSize   = pool->uiStackSize + page;
+    pool->uiMemorySize = pool->uiSlotSize * iCount;
+    pool->puiMemory    = mmap(0, pool->uiMemorySize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (pool->puiMemory == MAP_FAILED){
+        pool->puiMemory = 0;
+        return TT_NOK;
+    }
+    for (int i = 0 ; i < iCount ; i++){
+        uint8_t* stack = pool->puiMemory + i * pool->uiSlotSize + page;
+        if (mprotect(stack, pool->uiStackSize, PROT_READ | PROT_WRITE)){
+            TTDelay_fiber_pool_destroy(pool);
+            return TT_NOK;
+        }
+        pool->fiber[i].puiStack = stack;
+        pool->fiber[i].tt       = 0;
+        // lowest slot is taken first
+        pool->iFree[i]          = iCount - 1 - i;
+    }
+    pool->iCount     = iCount;
+    pool->iFreeCount = iCount;
+    return TT_OK;
+}
+
+/* unmap all stacks. fiber tasks that did not end must be deleted before. */
+void TTDelay_fiber_pool_destroy(TTDelay_fiber_pool_t* pool){
+    if (pool->puiMemory)
+        munmap(pool->puiMemory, pool->uiMemorySize);
+    pool->puiMemory  = 0;
+    pool->iCount     = 0;
+    pool->iFreeCount = 0;
+}
+
+/* create a task in tt that runs func(input_param, output_param) on a stack of
+ * the pool. the task is due right away and ends when func returns. the input
+ * parameter of the task itself (TTDelay_get_task_input_param_pointer) is the
+ * TTDelay_fiber_t. */
+int TTDelay_fiber_create(TTDelay_fiber_pool_t* pool, TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority){
+    TTDelay_fiber_t* fiber;
+    int              result;
+
+    if (!pool->iFreeCount)
+        TTDelay_fiber_reclaim(pool);
+    if (!pool->iFreeCount)
+        return TT_ERROR_TOO_MANY_TASKS;
+    fiber = &pool->fiber[pool->iFree[pool->iFreeCount - 1]];
+    result = TTDelay_create_task_r(tt, TTDelay_fiber_task, fiber, pool, priority);
+    if (result != TT_OK)
+        return result;
+    pool->iFreeCount--;
+
+    fiber->tt                 = tt;
+    fiber->iTask              = TTDelay_get_last_created_r(tt);
+    fiber->func               = func;
+    fiber->pvFuncParameterIn  = input_param;
+    fiber->pvFuncParameterOut = output_param;
+    fiber->fDone              = 0;
+#if TT_FIBER_UCONTEXT
+    getcontext(&fiber->context);
+    fiber->context.uc_stack.ss_sp   = fiber->puiStack;
+    fiber->context.uc_stack.ss_size = pool->uiStackSize;
+    fiber->context.uc_link          = &fiber->caller;
+    makecontext(&fiber->context, TTDelay_fiber_entry, 0);
+#else
+    // the first switch pops this frame and returns into TTDelay_fiber_entry()
+    // with the stack aligned as after a call
+    uint64_t* frame = (uint64_t*)(fiber->puiStack + pool->uiStackSize) - 9;
+    frame[0] = TT_FIBER_MXCSR | ((uint64_t)TT_FIBER_FPU_CW << 32);
+    for (int i = 1 ; i < 7 ; i++)
+        frame[i] = 0;                   // r15..rbp
+    frame[7] = (uint64_t)(uintptr_t)TTDelay_fiber_entry;
+    frame[8] = 0;                       // return address of TTDelay_fiber_entry, never used
+    fiber->pvStackPointer = frame;
+#endif
+    return TT_OK;
+}
+
+/* to be called by a fiber: continue 'ticks' timer ticks after the start of the
+ * current task run (TTDelay_from_now), other tasks run meanwhile. 0 continues
+ * on the next run, after the other due tasks. */
+void TTDelay_fiber_sleep(int ticks){
+    TTDelay_fiber_t* fiber = ttFiber;
+    TTDelay_from_now(ticks);
+#if TT_FIBER_UCONTEXT
+    swapcontext(&fiber->context, &fiber->caller);
+#else
+    TTDelay_fiber_switch(&fiber->pvStackPointer, fiber->pvCallerStackPointer);
+#endif
+}
+
+/*******************************************************************************
+* I N T E R N A L   F U N C T I O N S
+*******************************************************************************/
+/* task function of every fiber: resume the fiber until it sleeps or ends */
+static void TTDelay_fiber_task(void* in, void* out){
+    TTDelay_fiber_t*      fiber    = (TTDelay_fiber_t*)in;
+    TTDelay_fiber_pool_t* pool     = (TTDelay_fiber_pool_t*)out;
+    TTDelay_fiber_t*      previous = ttFiber;
+
+    ttFiber = fiber;
+#if TT_FIBER_UCONTEXT
+    swapcontext(&fiber->caller, &fiber->context);
+#else
+    TTDelay_fiber_switch(&fiber->pvCallerStackPointer, fiber->pvStackPointer);
+#endif
+    ttFiber = previous;
+
+    if (fiber->fDone){
+        fiber->tt = 0;
+        pool->iFree[pool->iFreeCount++] = (int)(fiber - pool->fiber);
+        TTDelay_delete_task_r(TTDelay_get_current_instance(), TTDelay_get_current_task());
+    }
+}
+
+/* give back the stacks of fiber tasks that were deleted before their function
+ * returned. the task is gone or its index went to another task. the running
+ * fiber keeps its stack, it may have deleted its own task. */
+static void TTDelay_fiber_reclaim(TTDelay_fiber_pool_t* pool){
+    for (int i = 0 ; i < pool->iCount ; i++){
+        TTDelay_fiber_t* fiber = &pool->fiber[i];
+        TTDelay_task_t*  task;
+        if (!fiber->tt || (fiber == ttFiber))
+            continue;
+        task = TTDelay_get_task_r(fiber->tt, fiber->iTask);
+        if (!task || (task->pvFuncParameterIn != fiber)){
+            fiber->tt = 0;
+            pool->iFree[pool->iFreeCount++] = i;
+        }
+    }
+}
+
+/* first function on the stack of a fiber. with ucontext it returns to
+ * fiber->caller (uc_link), otherwise it switches back for the last time. */
+static void TTDelay_fiber_entry(void){
+    TTDelay_fiber_t* fiber = ttFiber;
+    fiber->func(fiber->pvFuncParameterIn, fiber->pvFuncParameterOut);
+    fiber->fDone = 1;
+#if !TT_FIBER_UCONTEXT
+    TTDelay_fiber_switch(&fiber->pvStackPointer, fiber->pvCallerStackPointer);
+#endif
+}
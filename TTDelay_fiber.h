@@ -0,0 +1,70 @@
+/**
+ * @file      TTDelay_fiber.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * optional stackful tasks for hosts: task functions that can wait anywhere in
+ * their call stack with TTDelay_fiber_sleep().
+ */
+
+#ifndef _TTDELAY_FIBER_H
+#define _TTDELAY_FIBER_H
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <stddef.h>
+#include "TTDelay.h"
+
+/*******************************************************************************
+* Defines
+*******************************************************************************/
+#if TT_FIBER_ASM_SWITCH && defined(__x86_64__)
+    #define TT_FIBER_UCONTEXT   0
+#else
+    #define TT_FIBER_UCONTEXT   1
+    #include <ucontext.h>
+#endif
+
+/*******************************************************************************
+* Types and Typedefs
+*******************************************************************************/
+typedef struct TTDelay_fiber_t {
+#if TT_FIBER_UCONTEXT
+    ucontext_t         context;         // of the fiber while it sleeps
+    ucontext_t         caller;          // of the task run that resumed it
+#else
+    void*              pvStackPointer;  // of the fiber while it sleeps
+    void*              pvCallerStackPointer; // of the task run that resumed it
+#endif
+    void               (*func )(void*, void*);
+    void*              pvFuncParameterIn;
+    void*              pvFuncParameterOut;
+    uint8_t*           puiStack;        // lowest address of the stack, the guard page is below
+    TTDelay_t*         tt;              // instance of the task, 0: the stack is free
+    int                iTask;
+    uint8_t            fDone;
+} TTDelay_fiber_t;
+
+/* stacks for fiber tasks, allocated once by TTDelay_fiber_pool_init() */
+typedef struct TTDelay_fiber_pool_t {
+    uint8_t*           puiMemory;       // all stacks and guard pages (mmap)
+    size_t             uiMemorySize;
+    size_t             uiStackSize;     // usable bytes per stack, multiple of the page size
+    size_t             uiSlotSize;      // stack and guard page
+    int                iCount;
+    int                iFreeCount;
+    int                iFree[ TT_FIBER_STACKS_MAX ];
+    TTDelay_fiber_t    fiber[ TT_FIBER_STACKS_MAX ];
+} TTDelay_fiber_pool_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int  TTDelay_fiber_pool_init   (TTDelay_fiber_pool_t* pool, int iCount, size_t uiStackSize);
+void TTDelay_fiber_pool_destroy(TTDelay_fiber_pool_t* pool);
+int  TTDelay_fiber_create      (TTDelay_fiber_pool_t* pool, TTDelay_t* tt, void (*func ), void* input_param, void* output_param, uint8_t priority);
+void TTDelay_fiber_sleep       (int ticks);
+
+#endif // _TTDELAY_FIBER_H
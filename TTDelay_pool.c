@@ -0,0 +1,284 @@
+/* ******************************************************************************
+ * @file      TTDelay_pool.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * runs the due tasks of a TTDelay instance on a pool of worker threads.
+ *
+ * @desription
+ * TTDelay_pool_run() replaces TTDelay_run_r() for an instance. It finds all
+ * due tasks and hands them out round robin to the deques of the workers. Each
+ * deque is kept in the order the tasks have to be started (priority, or
+ * deadline with TT_POLICY_EDF, then dispatch order), also across several
+ * TTDelay_pool_run() calls. An idle worker compares the heads of all deques
+ * and takes the task that goes first. On a tie its own deque wins, so it only
+ * steals when another deque holds a more urgent task or its own is empty.
+ * This way the waiting task with the highest priority is always started first.
+ * A dispatched task is marked as running (see TTDelay_task_begin_r) and is not
+ * looked at by the scheduler until a later TTDelay_pool_run() collects it, so
+ * a task never runs on two threads at once. The execution time is measured by
+ * the worker with TT_POOL_TICK_FUNC (no default, it has to count in
+ * TT_READ_RST_TICK_FUNC ticks) and added to the task statistics by the
+ * thread that owns the instance.
+ * Task functions use the thread local current instance, so TT_THREAD_LOCAL has
+ * to be set in TTDelay_config.h. They may delete or suspend themselves (taken
+ * out when collected), other tasks are changed with TTDelay_post_command_r().
+ * *****************************************************************************/
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include "TTDelay_pool.h"
+
+/*******************************************************************************
+* Defines
+*******************************************************************************/
+#define TT_POOL_STR_(x)     #x
+#define TT_POOL_STR(x)      TT_POOL_STR_(x)
+
+// compile error if TT_THREAD_LOCAL is empty
+typedef char TTDelay_pool_needs_TT_THREAD_LOCAL[(sizeof(TT_POOL_STR(TT_THREAD_LOCAL)) > 1) ? 1 : -1];
+
+// task functions record trace events on the worker threads, the ring has one writer
+#if TT_TRACE
+    #error "TT_TRACE can not be used with the worker pool"
+#endif
+// see TTDelay_config.h, a default would mix up the units of the statistics
+#ifndef TT_POOL_TICK_FUNC
+    #error "TT_POOL_TICK_FUNC has to be defined, a free running counter in TT_READ_RST_TICK_FUNC ticks"
+#endif
+
+/*******************************************************************************
+* Static Function Prototypes
+*******************************************************************************/
+TT_TIMER_TYPE TTDelay_time_measure(TTDelay_t* tt, TT_CPU_TICK_TYPE* puiAddTimeToValue);
+static void  TTDelay_pool_push(TTDelay_pool_deque_t* deque, const TTDelay_pool_entry_t* entry);
+static void* TTDelay_pool_worker(void* arg);
+
+/*******************************************************************************
+* F U N C T I O N S   U S E D   I N   U S E R   P R O G R A M
+*******************************************************************************/
+/* start iWorkerCount threads that run the tasks of tt. the pool has to be
+ * zeroed (static storage) and tt must not be run with TTDelay_run_r() anymore. */
+int TTDelay_pool_start(TTDelay_pool_t* pool, TTDelay_t* tt, int iWorkerCount){
+    if ((iWorkerCount < 1) || (iWorkerCount > TT_POOL_WORKERS_MAX))
+        return TT_NOK;
+
+    pool->tt            = tt;
+    pool->fStop         = 0;
+    pool->next_worker   = 0;
+    pool->running_count = 0;
+    pool->sequence      = 0;
+    pool->queued_count  = 0;
+    pool->done_count    = 0;
+    pthread_mutex_init(&pool->lock, 0);
+    pthread_cond_init(&pool->wake, 0);
+    for (pool->worker_count = 0 ; pool->worker_count < iWorkerCount ; pool->worker_count++){
+        TTDelay_pool_worker_t* worker = &pool->worker[pool->worker_count];
+        worker->pool        = pool;
+        worker->id          = pool->worker_count;
+        worker->deque.head  = 0;
+        worker->deque.count = 0;
+        pthread_mutex_init(&worker->deque.lock, 0);
+        if (pthread_create(&worker->thread, 0, TTDelay_pool_worker, worker)){
+            pthread_mutex_destroy(&worker->deque.lock);
+            TTDelay_pool_stop(pool);
+            return TT_NOK;
+        }
+    }
+    return TT_OK;
+}
+
+/* the pool version of TTDelay_run_r(), does not block.
+ * - measure idle time
+ * - finish the tasks the workers are done with (statistics, rescheduling)
+ * - dispatch all due tasks to the workers, highest priority first
+ * - returns TT_MORE_TASKS_SCHEDULED while tasks are still running */
+int TTDelay_pool_run(TTDelay_pool_t* pool){
+    TTDelay_t* tt = pool->tt;
+    int        count;
+
+    TTDelay_time_measure(tt, &tt->uiCpuIdleCycleTickCount);
+
+    pthread_mutex_lock(&pool->lock);
+    for (TT_TASK_INDEX_TYPE i = 0 ; i < pool->done_count ; i++){
+        TTDelay_task_end_r(tt, pool->done[i], pool->done_time[i]);
+    }
+    pool->running_count -= pool->done_count;
+    pool->done_count     = 0;
+    pthread_mutex_unlock(&pool->lock);
+
+    // all due tasks are started right away, so there is no aging
+    TTDelay_find_due_tasks_r(tt);
+    count = TTDelay_get_due_tasks_r(tt, pool->due, TT_TASK_COUNT_MAX);
+    for (int i = 0 ; i < count ; i++){
+        TTDelay_task_t*      task = TTDelay_get_task_r(tt, pool->due[i]);
+        TTDelay_pool_entry_t entry;
+        // the key is taken before the task begins, like TTDelay_due_before() sees it
+        entry.uiTask     = pool->due[i];
+        entry.uiSequence = pool->sequence++;
+        entry.uiPriority = task->uiCurrentPriority;
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+        entry.uiDeadline = task->uiTimeNextExecute + task->uiDeadline;
+#endif
+        TTDelay_task_begin_r(tt, entry.uiTask);
+        TTDelay_pool_push(&pool->worker[pool->next_worker].deque, &entry);
+        pool->next_worker = (pool->next_worker + 1) % pool->worker_count;
+    }
+    pool->running_count += count;
+
+    if (count){
+        pthread_mutex_lock(&pool->lock);
+        pool->queued_count += count;
+        if (count == 1)
+            pthread_cond_signal(&pool->wake);
+        else
+            pthread_cond_broadcast(&pool->wake);
+        pthread_mutex_unlock(&pool->lock);
+    }
+
+    TTDelay_time_measure(tt, &tt->uiCpuTtsysCycleTickCount);
+    if (pool->running_count)
+        return TT_MORE_TASKS_SCHEDULED;
+    return TT_OK;
+}
+
+/* stop all workers after their current task and hand the instance back.
+ * tasks that were dispatched but not started are due again afterwards. */
+void TTDelay_pool_stop(TTDelay_pool_t* pool){
+    TTDelay_t* tt = pool->tt;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->fStop = 1;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->lock);
+
+    for (uint8_t w = 0 ; w < pool->worker_count ; w++){
+        TTDelay_pool_deque_t* deque = &pool->worker[w].deque;
+        pthread_join(pool->worker[w].thread, 0);
+        for ( ; deque->count ; deque->count--, deque->head = (deque->head + 1) % TT_TASK_COUNT_MAX){
+            TTDelay_task_cancel_r(tt, deque->entry[deque->head].uiTask);
+        }
+        pthread_mutex_destroy(&deque->lock);
+    }
+    for (TT_TASK_INDEX_TYPE i = 0 ; i < pool->done_count ; i++){
+        TTDelay_task_end_r(tt, pool->done[i], pool->done_time[i]);
+    }
+    pool->done_count    = 0;
+    pool->running_count = 0;
+    pool->worker_count  = 0;
+    pthread_cond_destroy(&pool->wake);
+    pthread_mutex_destroy(&pool->lock);
+}
+
+
+/*******************************************************************************
+* I N T E R N A L   F U N C T I O N S
+*******************************************************************************/
+// < 0 if task a has to be started before b, the dispatch order is left out.
+// deadlines are compared as difference, like TTDelay_due_before()
+static int TTDelay_pool_compare(const TTDelay_pool_entry_t* a, const TTDelay_pool_entry_t* b){
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TT_TIMER_TYPE diff = (TT_TIMER_TYPE)(a->uiDeadline - b->uiDeadline);
+    if (diff)
+        return (diff >> (sizeof(TT_TIMER_TYPE) * 8 - 1)) ? -1 : 1;
+#endif
+    return (int)a->uiPriority - (int)b->uiPriority;
+}
+
+static int TTDelay_pool_before(const TTDelay_pool_entry_t* a, const TTDelay_pool_entry_t* b){
+    int order = TTDelay_pool_compare(a, b);
+    if (order)
+        return order < 0;
+    return (int32_t)(a->uiSequence - b->uiSequence) < 0;
+}
+
+// insert in order, searched from the back: a new task mostly goes last
+static void TTDelay_pool_push(TTDelay_pool_deque_t* deque, const TTDelay_pool_entry_t* entry){
+    int pos;
+    pthread_mutex_lock(&deque->lock);
+    for (pos = deque->count ; pos ; pos--){
+        TTDelay_pool_entry_t* previous = &deque->entry[(deque->head + pos - 1) % TT_TASK_COUNT_MAX];
+        if (!TTDelay_pool_before(entry, previous))
+            break;
+        deque->entry[(deque->head + pos) % TT_TASK_COUNT_MAX] = *previous;
+    }
+    deque->entry[(deque->head + pos) % TT_TASK_COUNT_MAX] = *entry;
+    deque->count++;
+    pthread_mutex_unlock(&deque->lock);
+}
+
+// take the waiting task that goes first, looking at the head of every deque.
+// returns 0 if another worker was faster or a more urgent task was pushed
+// meanwhile, the caller tries again.
+static int TTDelay_pool_take(TTDelay_pool_t* pool, uint8_t id, TT_TASK_INDEX_TYPE* puiIndex){
+    TTDelay_pool_deque_t* deque;
+    TTDelay_pool_entry_t  best = { 0 }, head;
+    int                   from = -1, found;
+
+    for (uint8_t n = 0 ; n < pool->worker_count ; n++){
+        uint8_t w = (id + n) % pool->worker_count;
+        deque = &pool->worker[w].deque;
+        pthread_mutex_lock(&deque->lock);
+        found = deque->count;
+        if (found)
+            head = deque->entry[deque->head];
+        pthread_mutex_unlock(&deque->lock);
+        if (!found)
+            continue;
+        // the own deque (looked at first) is only left for a more urgent task
+        if ((from < 0) || ((from == id) ? (TTDelay_pool_compare(&head, &best) < 0)
+                                        : TTDelay_pool_before(&head, &best))){
+            best = head;
+            from = w;
+        }
+    }
+    if (from < 0)
+        return 0;
+
+    deque = &pool->worker[from].deque;
+    pthread_mutex_lock(&deque->lock);
+    found = deque->count && (deque->entry[deque->head].uiSequence == best.uiSequence);
+    if (found){
+        deque->head = (deque->head + 1) % TT_TASK_COUNT_MAX;
+        deque->count--;
+    }
+    pthread_mutex_unlock(&deque->lock);
+    *puiIndex = best.uiTask;
+    return found;
+}
+
+static void* TTDelay_pool_worker(void* arg){
+    TTDelay_pool_worker_t* worker = (TTDelay_pool_worker_t*)arg;
+    TTDelay_pool_t*        pool   = worker->pool;
+    TT_TASK_INDEX_TYPE     index;
+    TT_TIMER_TYPE          uiStart, uiExecuteTime;
+
+    while (1){
+        // reserve one of the queued tasks. it sits in one of the deques and
+        // no other worker can take it, so the search below always succeeds
+        pthread_mutex_lock(&pool->lock);
+        while ((!pool->queued_count) && (!pool->fStop))
+            pthread_cond_wait(&pool->wake, &pool->lock);
+        if (pool->fStop){
+            pthread_mutex_unlock(&pool->lock);
+            return 0;
+        }
+        pool->queued_count--;
+        pthread_mutex_unlock(&pool->lock);
+
+        while (!TTDelay_pool_take(pool, worker->id, &index))
+            ;
+
+        uiStart = TT_POOL_TICK_FUNC;
+        TTDelay_task_execute_r(pool->tt, index);
+        uiExecuteTime = TT_POOL_TICK_FUNC - uiStart;
+
+        pthread_mutex_lock(&pool->lock);
+        pool->done     [pool->done_count] = index;
+        pool->done_time[pool->done_count] = uiExecuteTime;
+        pool->done_count++;
+        pthread_mutex_unlock(&pool->lock);
+    }
+}
@@ -0,0 +1,75 @@
+/**
+ * @file      TTDelay_pool.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * optional executor that runs the due tasks of a TTDelay instance on a pool
+ * of pthread workers instead of the calling thread.
+ */
+
+#ifndef _TTDELAY_POOL_H
+#define _TTDELAY_POOL_H
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <pthread.h>
+#include "TTDelay.h"
+
+/*******************************************************************************
+* Types and Typedefs
+*******************************************************************************/
+// a dispatched task and the key it is ordered by, taken when it is dispatched
+typedef struct TTDelay_pool_entry_t {
+    uint32_t           uiSequence;      // dispatch order, the older task wins a tie
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TT_TIMER_TYPE      uiDeadline;
+#endif
+    TT_TASK_INDEX_TYPE uiTask;
+    uint8_t            uiPriority;
+} TTDelay_pool_entry_t;
+
+// tasks waiting for a worker, the one to start first at head
+typedef struct TTDelay_pool_deque_t {
+    pthread_mutex_t    lock;
+    TT_TASK_INDEX_TYPE head;
+    TT_TASK_INDEX_TYPE count;
+    TTDelay_pool_entry_t entry[ TT_TASK_COUNT_MAX ];
+} TTDelay_pool_deque_t;
+
+typedef struct TTDelay_pool_worker_t {
+    struct TTDelay_pool_t* pool;
+    pthread_t          thread;
+    uint8_t            id;
+    TTDelay_pool_deque_t deque;
+} TT_INSTANCE_ALIGN TTDelay_pool_worker_t;
+
+/* a pool runs the tasks of one instance. TTDelay_pool_run() has to be called
+ * by a single thread, the one that owns the instance. */
+typedef struct TTDelay_pool_t {
+    TTDelay_t*         tt;
+    uint8_t            worker_count;
+    uint8_t            next_worker;                 // first worker of the next dispatch
+    TT_TASK_INDEX_TYPE running_count;               // dispatched and not ended yet
+    uint32_t           sequence;                    // tasks dispatched so far
+    TT_TASK_INDEX_TYPE due[ TT_TASK_COUNT_MAX ];
+    // everything below is protected by lock
+    pthread_mutex_t    lock;
+    pthread_cond_t     wake;
+    uint8_t            fStop;
+    TT_TASK_INDEX_TYPE queued_count;                // in a deque and not taken by a worker
+    TT_TASK_INDEX_TYPE done_count;
+    TT_TASK_INDEX_TYPE done     [ TT_TASK_COUNT_MAX ];
+    TT_TIMER_TYPE      done_time[ TT_TASK_COUNT_MAX ];
+    TTDelay_pool_worker_t worker[ TT_POOL_WORKERS_MAX ];
+} TTDelay_pool_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+int  TTDelay_pool_start(TTDelay_pool_t* pool, TTDelay_t* tt, int iWorkerCount);
+int  TTDelay_pool_run  (TTDelay_pool_t* pool);
+void TTDelay_pool_stop (TTDelay_pool_t* pool);
+
+#endif // _TTDELAY_POOL_H
@@ -0,0 +1,121 @@
+/* ******************************************************************************
+ * @file      TTDelay_sleep.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * tickless run loop for hosts: run all due tasks, then sleep until the next
+ * task is due.
+ *
+ * @desription
+ * TTDelay_sleep_run() runs the due tasks of an instance and blocks on a
+ * condition variable until TTDelay_get_remaining_idle_time_r() ticks have
+ * passed. The deadline is absolute and counted from the start of the current
+ * tick, so TT_TIMER_FUNC has to count CLOCK_MONOTONIC in TT_TICK_NS steps, as
+ * TTDelay_sleep_ticks() does. Another thread that changes
+ * the schedule, e.g. creates a task, calls TTDelay_sleep_wakeup() to end the
+ * sleep early. TTDelay_notify_r() and TTDelay_post_command_r() on the
+ * instance do so through the wake hook (see TTDelay_set_wake_hook_r). Rescheduling done by the tasks themselves
+ * needs no wakeup, the idle time is looked up after they ran.
+ * *****************************************************************************/
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <errno.h>
+#include <time.h>
+#include "TTDelay_sleep.h"
+
+/*******************************************************************************
+* F U N C T I O N S   U S E D   I N   U S E R   P R O G R A M
+*******************************************************************************/
+static uint64_t TTDelay_sleep_ns(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+}
+
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+// wake hook of the instance, see TTDelay_sleep_init()
+static void TTDelay_sleep_hook(void* context){
+    TTDelay_sleep_wakeup((TTDelay_sleep_t*)context);
+}
+#endif
+
+/* CLOCK_MONOTONIC in TT_TICK_NS ticks, to be used as TT_TIMER_FUNC */
+TT_TIMER_TYPE TTDelay_sleep_ticks(void){
+    return (TT_TIMER_TYPE)(TTDelay_sleep_ns() / TT_TICK_NS);
+}
+
+int TTDelay_sleep_init(TTDelay_sleep_t* sleeper, TTDelay_t* tt){
+    pthread_condattr_t attr;
+    int                error;
+
+    sleeper->tt      = tt;
+    sleeper->fWakeup = 0;
+    if (pthread_mutex_init(&sleeper->lock, 0))
+        return TT_NOK;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    error = pthread_cond_init(&sleeper->wake, &attr);
+    pthread_condattr_destroy(&attr);
+    if (error){
+        pthread_mutex_destroy(&sleeper->lock);
+        return TT_NOK;
+    }
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+    // a notified task or a posted command ends the sleep
+    TTDelay_set_wake_hook_r(tt, TTDelay_sleep_hook, sleeper);
+#endif
+    return TT_OK;
+}
+
+/* run all due tasks, then sleep until the next task is due or
+ * TTDelay_sleep_wakeup() is called. call this in an endless loop. */
+int TTDelay_sleep_run(TTDelay_sleep_t* sleeper){
+    TT_TIMER_TYPE   uiIdle;
+    struct timespec deadline;
+    uint64_t        ns;
+
+    while (TTDelay_run_r(sleeper->tt) == TT_MORE_TASKS_SCHEDULED)
+        ;
+    // the idle time counts from the tick TT_TIMER_FUNC is in, which starts at
+    // or after this one. waking up a bit early only costs another round
+    ns     = TTDelay_sleep_ns();
+    ns    -= ns % TT_TICK_NS;
+    uiIdle = TTDelay_get_remaining_idle_time_r(sleeper->tt);
+
+    pthread_mutex_lock(&sleeper->lock);
+    if (uiIdle == TT_IDLE_FOREVER){
+        while (!sleeper->fWakeup)
+            pthread_cond_wait(&sleeper->wake, &sleeper->lock);
+    } else if (uiIdle){
+        ns               += (uint64_t)uiIdle * TT_TICK_NS;
+        deadline.tv_sec   = ns / 1000000000;
+        deadline.tv_nsec  = ns % 1000000000;
+        while (!sleeper->fWakeup){
+            if (pthread_cond_timedwait(&sleeper->wake, &sleeper->lock, &deadline) == ETIMEDOUT)
+                break;
+        }
+    }
+    sleeper->fWakeup = 0;
+    pthread_mutex_unlock(&sleeper->lock);
+    return TT_OK;
+}
+
+/* end the current (or next) sleep of TTDelay_sleep_run() right away.
+ * may be called from any thread, but not from a signal handler. */
+void TTDelay_sleep_wakeup(TTDelay_sleep_t* sleeper){
+    pthread_mutex_lock(&sleeper->lock);
+    sleeper->fWakeup = 1;
+    pthread_cond_signal(&sleeper->wake);
+    pthread_mutex_unlock(&sleeper->lock);
+}
+
+void TTDelay_sleep_destroy(TTDelay_sleep_t* sleeper){
+#if TT_TASK_EVENTS || TT_TASK_COMMANDS
+    TTDelay_set_wake_hook_r(sleeper->tt, 0, 0);
+#endif
+    pthread_cond_destroy(&sleeper->wake);
+    pthread_mutex_destroy(&sleeper->lock);
+}
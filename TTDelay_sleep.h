@@ -0,0 +1,39 @@
+/**
+ * @file      TTDelay_sleep.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * optional host run loop that sleeps until the next task of a TTDelay
+ * instance is due instead of polling TTDelay_run().
+ */
+
+#ifndef _TTDELAY_SLEEP_H
+#define _TTDELAY_SLEEP_H
+
+/*******************************************************************************
+* Includes
+*******************************************************************************/
+#include <pthread.h>
+#include "TTDelay.h"
+
+/*******************************************************************************
+* Types and Typedefs
+*******************************************************************************/
+typedef struct TTDelay_sleep_t {
+    TTDelay_t*         tt;
+    pthread_mutex_t    lock;
+    pthread_cond_t     wake;
+    uint8_t            fWakeup;     // set by TTDelay_sleep_wakeup(), protected by lock
+} TTDelay_sleep_t;
+
+/*******************************************************************************
+* Function Prototypes
+*******************************************************************************/
+TT_TIMER_TYPE TTDelay_sleep_ticks(void);
+int  TTDelay_sleep_init   (TTDelay_sleep_t* sleeper, TTDelay_t* tt);
+int  TTDelay_sleep_run    (TTDelay_sleep_t* sleeper);
+void TTDelay_sleep_wakeup (TTDelay_sleep_t* sleeper);
+void TTDelay_sleep_destroy(TTDelay_sleep_t* sleeper);
+
+#endif // _TTDELAY_SLEEP_H
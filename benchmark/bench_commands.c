@@ -0,0 +1,111 @@
+/**
+ * @file      bench_commands.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * contention on the command queue (TT_TASK_COMMANDS): [producers] threads post
+ * [commands] commands each to random tasks while the main thread runs the
+ * scheduler, which applies them at the start of every TTDelay_run().
+ *
+ *     bench_commands [producers] [commands per producer]
+ *
+ * Half of the commands move a task (TT_COMMAND_FROM_NOW), half change its
+ * priority. A post that finds the queue full is retried, those are counted.
+ * Printed are the time per successful post seen by a producer, the commands
+ * applied per second and the retries. At the end every posted command has to
+ * be applied.
+ */
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "TTDelay.h"
+
+#define BENCH_TASKS         128
+
+uint32_t                benchmark_time;
+static long             commands;
+static volatile int     started;
+static volatile int     finished;
+static double           post_ns[ 64 ];
+static long             full[ 64 ];
+static long             runs;
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void bench_task(void* in, void* out) {
+    runs++;
+    TTDelay_from_now(1000000);
+}
+
+static void* bench_producer(void* arg) {
+    long     id    = (long)arg;
+    uint32_t state = (uint32_t)id + 1;
+    double   start;
+
+    while (!started)
+        sched_yield();
+    start = bench_now_ns();
+    for (long i = 0 ; i < commands ; i++){
+        state = state * 1103515245u + 12345u;
+        int     task  = (state >> 8) % BENCH_TASKS;
+        uint8_t type  = (i & 1) ? TT_COMMAND_PRIORITY : TT_COMMAND_FROM_NOW;
+        while (TTDelay_post_command(task, type, (state >> 16) & 0xFF) != TT_OK){
+            full[id]++;
+            sched_yield();
+        }
+    }
+    post_ns[id] = (bench_now_ns() - start) / commands;
+    __atomic_fetch_add(&finished, 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    long      producers = (argc > 1) ? atol(argv[1]) : 4;
+    pthread_t thread[ 64 ];
+    double    start, duration, ns = 0;
+    long      retries = 0;
+
+    commands = (argc > 2) ? atol(argv[2]) : 1000000;
+    if ((producers < 1) || (producers > 64) || (commands < 1)){
+        fprintf(stderr, "1..64 producers\n");
+        return 1;
+    }
+    for (int i = 0 ; i < BENCH_TASKS ; i++)
+        TTDelay_create_task(bench_task, NULL, NULL, 5);
+    for (long p = 0 ; p < producers ; p++)
+        pthread_create(&thread[p], 0, bench_producer, (void*)p);
+
+    start   = bench_now_ns();
+    started = 1;
+    while (__atomic_load_n(&finished, __ATOMIC_ACQUIRE) < producers){
+        benchmark_time++;
+        TTDelay_run();
+        // nothing to do, as a real system would sleep here
+        if (TTDelay_get_remaining_idle_time())
+            sched_yield();
+    }
+    // the last commands
+    TTDelay_run();
+    duration = bench_now_ns() - start;
+    for (long p = 0 ; p < producers ; p++){
+        pthread_join(thread[p], 0);
+        ns      += post_ns[p];
+        retries += full[p];
+    }
+
+    printf("commands: %ld producers, queue %d, %.1f ns/post, %.2f M commands/s applied, %ld retries (queue full), %ld task runs\n",
+        producers, TT_COMMAND_QUEUE_SIZE, ns / producers, producers * commands / duration * 1e3, retries, runs);
+    if (TTDelay_get_current_instance()->command_head != (uint32_t)(producers * commands)){
+        printf("commands lost: %u of %ld applied\n", TTDelay_get_current_instance()->command_head, producers * commands);
+        return 1;
+    }
+    return 0;
+}
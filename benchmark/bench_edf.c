@@ -0,0 +1,93 @@
+/**
+ * @file      bench_edf.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * counts the missed deadlines of random periodic task sets with the scheduling
+ * policy the binary was built with (TT_POLICY_PRIORITY with aging or TT_POLICY_EDF).
+ *
+ * Every task set has <tasks> periodic tasks with periods of TT_BENCH_PERIOD_MIN..
+ * TT_BENCH_PERIOD_MAX ticks and random priorities. The execution times are
+ * chosen so that the task set has the given utilization. A task moves the time
+ * forward by its execution time, so the runs do not overlap and a task can not
+ * be preempted. A run misses its deadline if it ends after its next execute
+ * time plus the period. The same seed gives the same task sets for both binaries:
+ *
+ *     bench_edf_priority <utilization> [tasks] [sets] [ticks]
+ *     bench_edf_edf      <utilization> [tasks] [sets] [ticks]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "TTDelay.h"
+
+#define TT_BENCH_PERIOD_MIN     20
+#define TT_BENCH_PERIOD_MAX     1000
+
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    #define POLICY_NAME "edf"
+#else
+    #define POLICY_NAME "priority"
+#endif
+
+uint32_t        benchmark_time;
+static uint32_t random_state = 1;
+static TT_TIMER_TYPE execute_time[ TT_TASK_COUNT_MAX ];
+static uint64_t run_count, missed_count;
+
+static uint32_t bench_random(void) {
+    random_state = random_state * 1103515245u + 12345u;
+    return random_state >> 8;
+}
+
+static void bench_task(void* in, void* out) {
+    int           id      = (int)(intptr_t)in;
+    TT_TIMER_TYPE release = TTDelay_get_next_schedule_time(id);
+
+    benchmark_time += execute_time[id];
+    run_count++;
+    if (benchmark_time > release + TTDelay_get_task(id)->uiPeriod)
+        missed_count++;
+}
+
+int main(int argc, char** argv) {
+    double   utilization = (argc > 1) ? atof(argv[1]) : 0.8;
+    long     tasks = (argc > 2) ? atol(argv[2]) : 16;
+    long     sets  = (argc > 3) ? atol(argv[3]) : 50;
+    long     ticks = (argc > 4) ? atol(argv[4]) : 100000;
+    double   weight[ TT_TASK_COUNT_MAX ], weight_sum, real_utilization = 0;
+
+    if ((tasks < 1) || (tasks > TT_TASK_COUNT_MAX)){
+        fprintf(stderr, "1..%d tasks\n", TT_TASK_COUNT_MAX);
+        return 1;
+    }
+    for (long s = 0 ; s < sets ; s++){
+        TTDelay_reset();
+        benchmark_time = 0;
+        weight_sum     = 0;
+        for (long i = 0 ; i < tasks ; i++){
+            weight[i]   = 1 + bench_random() % 100;
+            weight_sum += weight[i];
+        }
+        for (long i = 0 ; i < tasks ; i++){
+            TT_TIMER_TYPE period = TT_BENCH_PERIOD_MIN + bench_random() % (TT_BENCH_PERIOD_MAX - TT_BENCH_PERIOD_MIN + 1);
+            execute_time[i] = (TT_TIMER_TYPE)(utilization * weight[i] / weight_sum * period + 0.5);
+            if (!execute_time[i])
+                execute_time[i] = 1;
+            real_utilization += (double)execute_time[i] / period;
+            TTDelay_create_task_periodic(bench_task, (void*)(intptr_t)i, NULL, 16 + bench_random() % 240, period);
+        }
+        while (benchmark_time < (uint32_t)ticks){
+            uint64_t before = run_count;
+            TTDelay_run();
+            if (run_count == before)
+                benchmark_time++;
+        }
+    }
+
+    printf("%-8s %4.2f utilization (%4.2f) %3ld tasks %10llu runs %8llu missed %6.2f %%\n",
+        POLICY_NAME, utilization, real_utilization / sets, tasks, (unsigned long long)run_count,
+        (unsigned long long)missed_count, run_count ? 100.0 * missed_count / run_count : 0.0);
+    return 0;
+}
@@ -0,0 +1,113 @@
+/**
+ * @file      bench_engines.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * compares the scheduler engines (TT_SCHEDULER_ENGINE) with many tasks.
+ *
+ * Every task reschedules itself with TTDelay_from_now() and a pseudo random
+ * delay of 1..TT_BENCH_MAX_DELAY ticks. The time moves one tick per loop and
+ * all due tasks are run before the next tick. The binary is built once per
+ * engine and task layout (see Makefile), the task count is given on the command line:
+ *
+ *     bench_engines_wheel <tasks> [ticks] [batch]
+ *
+ * without [ticks] (or with 0), the number of ticks is lowered for large task
+ * counts so the linear engine finishes in reasonable time. with "batch" the
+ * due tasks of a tick are run by one TTDelay_run_batch() call instead of
+ * calling TTDelay_run() until TT_OK.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "TTDelay.h"
+
+#ifndef TT_BENCH_MAX_DELAY
+#define TT_BENCH_MAX_DELAY      10000
+#endif
+
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+    #define ENGINE_NAME "linear"
+#elif TT_SCHEDULER_ENGINE == TT_ENGINE_HEAP
+    #define ENGINE_NAME "heap"
+#else
+    #define ENGINE_NAME "wheel"
+#endif
+
+#if TT_TRACE
+    #define LAYOUT_NAME "trace"
+#elif TT_READY_BITMAP
+    #define LAYOUT_NAME "bmap"
+#elif TT_SCAN_MASK && defined(__AVX2__)
+    #define LAYOUT_NAME "avx2"
+#elif TT_SCAN_MASK
+    #define LAYOUT_NAME "mask"
+#elif TT_TASK_LAYOUT == TT_LAYOUT_SPLIT
+    #define LAYOUT_NAME "split"
+#else
+    #define LAYOUT_NAME "aos"
+#endif
+
+uint32_t        benchmark_time;
+static uint32_t random_state = 1;
+static uint64_t dispatch_count;
+
+static uint32_t bench_random(void) {
+    random_state = random_state * 1103515245u + 12345u;
+    return random_state >> 8;
+}
+
+static void bench_task(void* in, void* out) {
+    dispatch_count++;
+    TTDelay_from_now(1 + bench_random() % TT_BENCH_MAX_DELAY);
+}
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+int main(int argc, char** argv) {
+    long     tasks = (argc > 1) ? atol(argv[1]) : 1000;
+    long     ticks = (argc > 2) ? atol(argv[2]) : 0;
+    int      batch = (argc > 3) && !strcmp(argv[3], "batch");
+    uint64_t run_count = 0;
+    double   start, duration;
+
+    if (!ticks){
+        ticks = 20000000 / (tasks ? tasks : 1);
+        if (ticks > 20000)
+            ticks = 20000;
+        if (ticks < 200)
+            ticks = 200;
+    }
+    if (tasks > TT_TASK_COUNT_MAX){
+        fprintf(stderr, "built for %d tasks at most\n", TT_TASK_COUNT_MAX);
+        return 1;
+    }
+    for (long i = 0 ; i < tasks ; i++){
+        benchmark_time = bench_random() % TT_BENCH_MAX_DELAY;
+        TTDelay_create_task(bench_task, NULL, NULL, bench_random() % 256);
+    }
+
+    benchmark_time = 0;
+    start = bench_now_ns();
+    for (long t = 0 ; t < ticks ; t++, benchmark_time++){
+        run_count++;
+        if (batch)
+            TTDelay_run_batch(0, 0);
+        else
+            while (TTDelay_run() == TT_MORE_TASKS_SCHEDULED)
+                run_count++;
+    }
+    duration = bench_now_ns() - start;
+
+    printf("%-8s %-5s %-5s %8ld tasks %10llu runs %10llu dispatches %10.1f ns/run %10.1f ns/dispatch\n",
+        ENGINE_NAME, LAYOUT_NAME, batch ? "batch" : "run", tasks, (unsigned long long)run_count, (unsigned long long)dispatch_count,
+        duration / run_count, dispatch_count ? duration / dispatch_count : 0.0);
+    return 0;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file      bench_fiber.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * cost of stackful tasks (TTDelay_fiber.c): time per context switch and
+ * memory per fiber task.
+ *
+ *     bench_fiber [fibers] [stack use in bytes]
+ *
+ * switch: a plain task and a fiber task reschedule themselves on every run
+ * (TTDelay_from_now(0) and TTDelay_fiber_sleep(0)), the difference of the time
+ * per TTDelay_run() is the cost of resuming and suspending the fiber. The bare
+ * swapcontext() pair is measured as well, bench_fiber_ucontext switches with it
+ * (TT_FIBER_ASM_SWITCH 0).
+ * memory: [fibers] fiber tasks use [stack use] bytes of stack each and sleep
+ * one tick at a time. the resident stack pages are counted with mincore().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/mman.h>
+#include <ucontext.h>
+#include <unistd.h>
+#include "TTDelay_fiber.h"
+
+#define BENCH_RUNS      1000000
+
+uint32_t                    benchmark_time;
+static TTDelay_fiber_pool_t pool;
+static ucontext_t           main_context, ping_context;
+static long                 stack_use;
+static volatile long        sink;
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static void plain_task(void* in, void* out) {
+    TTDelay_from_now(0);
+}
+
+static void switch_fiber(void* in, void* out) {
+    for (long i = 0 ; i < BENCH_RUNS ; i++)
+        TTDelay_fiber_sleep(0);
+}
+
+// touches stack_use bytes of stack, then sleeps with all of it in use
+static void memory_fiber(void* in, void* out) {
+    volatile uint8_t buffer[stack_use];
+    memset((uint8_t*)buffer, 1, stack_use);
+    for (int i = 0 ; i < 10 ; i++){
+        TTDelay_fiber_sleep(1);
+        sink += buffer[i % stack_use];
+    }
+}
+
+static void ping(void) {
+    while (1)
+        swapcontext(&ping_context, &main_context);
+}
+
+static double bench_runs(long runs) {
+    double start = bench_now_ns();
+    for (long i = 0 ; i < runs ; i++)
+        TTDelay_run();
+    return (bench_now_ns() - start) / runs;
+}
+
+static size_t bench_resident(void) {
+    size_t         page  = (size_t)sysconf(_SC_PAGESIZE);
+    size_t         pages = pool.uiMemorySize / page;
+    unsigned char* vec   = malloc(pages);
+    size_t         count = 0;
+    mincore(pool.puiMemory, pool.uiMemorySize, vec);
+    for (size_t i = 0 ; i < pages ; i++)
+        count += vec[i] & 1;
+    free(vec);
+    return count * page;
+}
+
+int main(int argc, char** argv) {
+    long   fibers = (argc > 1) ? atol(argv[1]) : TT_FIBER_STACKS_MAX;
+    double plain_ns, fiber_ns, swap_ns, start;
+    static uint8_t ping_stack[16384];
+
+    stack_use = (argc > 2) ? atol(argv[2]) : 4096;
+    if ((fibers < 1) || (fibers > TT_FIBER_STACKS_MAX) || (fibers > TT_TASK_COUNT_MAX) || (stack_use < 1)){
+        fprintf(stderr, "1..%d fibers\n", TT_FIBER_STACKS_MAX);
+        return 1;
+    }
+
+    // bare swapcontext() there and back
+    getcontext(&ping_context);
+    ping_context.uc_stack.ss_sp   = ping_stack;
+    ping_context.uc_stack.ss_size = sizeof(ping_stack);
+    makecontext(&ping_context, ping, 0);
+    start = bench_now_ns();
+    for (long i = 0 ; i < BENCH_RUNS ; i++)
+        swapcontext(&main_context, &ping_context);
+    swap_ns = (bench_now_ns() - start) / BENCH_RUNS;
+
+    // switch cost inside the scheduler
+    TTDelay_create_task(plain_task, NULL, NULL, 5);
+    plain_ns = bench_runs(BENCH_RUNS);
+    TTDelay_reset();
+    TTDelay_fiber_pool_init(&pool, 1, 0);
+    TTDelay_fiber_create(&pool, TTDelay_get_current_instance(), switch_fiber, NULL, NULL, 5);
+    fiber_ns = bench_runs(BENCH_RUNS);
+    TTDelay_run();                      // ends the fiber
+    TTDelay_fiber_pool_destroy(&pool);
+    printf("switch: plain task %.1f ns/run, fiber task %.1f ns/run, resume + suspend %.1f ns, swapcontext pair %.1f ns\n",
+        plain_ns, fiber_ns, fiber_ns - plain_ns, swap_ns);
+
+    // memory
+    TTDelay_reset();
+    TTDelay_fiber_pool_init(&pool, (int)fibers, stack_use + 16384);
+    for (long i = 0 ; i < fibers ; i++)
+        TTDelay_fiber_create(&pool, TTDelay_get_current_instance(), memory_fiber, NULL, NULL, 5);
+    while (TTDelay_run() == TT_MORE_TASKS_SCHEDULED)
+        ;
+    printf("memory: %ld fibers, %ld bytes stack used, %zu reserved per fiber (stack + guard page), "
+           "%zu resident per fiber, %zu + %zu bytes fiber and task\n",
+        fibers, stack_use, pool.uiSlotSize, bench_resident() / fibers, sizeof(TTDelay_fiber_t), sizeof(TTDelay_task_t));
+    while (TTDelay_get_task_count() && (TTDelay_get_remaining_idle_time() != TT_IDLE_FOREVER)){
+        benchmark_time++;
+        while (TTDelay_run() == TT_MORE_TASKS_SCHEDULED)
+            ;
+    }
+    TTDelay_fiber_pool_destroy(&pool);
+    return 0;
+}
@@ -0,0 +1,239 @@
+/**
+ * @file      bench_overhead.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * measures the scheduler overhead: time per TTDelay_run() call, per
+ * TTDelay_find_due_tasks() pass and per TTDelay_adjust_priority() pass. The
+ * binary is built once per engine, aging (TT_ENABLE_TASK_AGING), CPU monitor
+ * (TT_MONITOR_CPU_LOAD, reads the time stamp counter then) and TT_TASK_COUNT_MAX,
+ * see Makefile. Every binary sweeps
+ *
+ *     tasks         1, 2, 4, .. up to [max tasks] (default TT_TASK_COUNT_MAX)
+ *     due_permille  share of the tasks due: 0, 10, 100, 500, 1000
+ *     priorities    equal, ascending or descending with the task index, random
+ *
+ * and prints one CSV line per measurement (ns and time stamp counter ticks per
+ * call, tsc is 0 on other than x86), so results of two releases can be compared
+ * line by line:
+ *
+ *     bench_overhead_linear [max tasks] [ms per measurement]
+ *
+ * run: the tasks reschedule themselves with a random delay that makes the given
+ *      share of them due per tick, the time moves one tick after all due tasks
+ *      were run. the time is per TTDelay_run() call, including the task run.
+ * find_due: the given share of the tasks is due, the others wait, the pass is
+ *      repeated without running a task.
+ * adjust_priority: same, the priorities aged by the pass are set back before
+ *      each pass, the time needed for that is measured alone and subtracted.
+ *      not measured without aging, TTDelay_run() does not call it then.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "TTDelay.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <x86intrin.h>
+    #define bench_tsc()     __rdtsc()
+#else
+    #define bench_tsc()     0
+#endif
+
+#if TT_SCHEDULER_ENGINE == TT_ENGINE_LINEAR
+    #define ENGINE_NAME "linear"
+#elif TT_SCHEDULER_ENGINE == TT_ENGINE_HEAP
+    #define ENGINE_NAME "heap"
+#else
+    #define ENGINE_NAME "wheel"
+#endif
+
+#ifdef TT_MONITOR_CPU_LOAD
+    #define CPU_MONITOR 1
+#else
+    #define CPU_MONITOR 0
+#endif
+
+#define BENCH_START_TIME    1000
+#define BENCH_WAIT_TIME     0x40000000
+
+typedef long (*bench_pass_t)(long reps);
+
+uint32_t            benchmark_time;
+static uint32_t     random_state;
+static uint64_t     tsc_read;
+static uint32_t     max_delay;
+static long         due_count;
+static TT_TASK_INDEX_TYPE due_index[ TT_TASK_COUNT_MAX ];
+static uint8_t      due_priority[ TT_TASK_COUNT_MAX ];
+
+static const uint16_t due_permilles[] = { 0, 10, 100, 500, 1000 };
+static const char*    priority_names[] = { "equal", "ascending", "descending", "random" };
+
+static uint32_t bench_random(void) {
+    random_state = random_state * 1103515245u + 12345u;
+    return random_state >> 8;
+}
+
+/* TT_READ_RST_TICK_FUNC with TT_BENCH_CPU_TICKS */
+uint32_t bench_read_reset_ticks(void) {
+    uint64_t now   = bench_tsc();
+    uint32_t ticks = (uint32_t)(now - tsc_read);
+    tsc_read = now;
+    return ticks;
+}
+
+static double bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+static uint8_t bench_priority(int distribution, long i, long tasks) {
+    switch (distribution){
+    case 0:  return 128;
+    case 1:  return (uint8_t)(i * 256 / tasks);
+    case 2:  return (uint8_t)(255 - i * 256 / tasks);
+    default: return (uint8_t)bench_random();
+    }
+}
+
+// spreads the due tasks evenly over the task indices
+static int bench_is_due(long i, uint16_t permille) {
+    return ((i + 1) * permille / 1000) > (i * permille / 1000);
+}
+
+static void bench_task(void* in, void* out) {
+    TTDelay_from_now(1 + bench_random() % max_delay);
+}
+
+static void bench_idle_task(void* in, void* out) {
+}
+
+static long bench_pass_run(long ticks) {
+    long calls = 0;
+    for (long t = 0 ; t < ticks ; t++, benchmark_time++){
+        calls++;
+        while (TTDelay_run() == TT_MORE_TASKS_SCHEDULED)
+            calls++;
+    }
+    return calls;
+}
+
+static long bench_pass_find_due(long reps) {
+    for (long r = 0 ; r < reps ; r++)
+        TTDelay_find_due_tasks();
+    return reps;
+}
+
+#if TT_ENABLE_TASK_AGING
+static long bench_pass_restore(long reps) {
+    for (long r = 0 ; r < reps ; r++){
+        for (long d = 0 ; d < due_count ; d++)
+            TTDelay_get_task(due_index[d])->uiCurrentPriority = due_priority[d];
+        __asm__ volatile("" ::: "memory");
+    }
+    return reps;
+}
+
+static long bench_pass_adjust(long reps) {
+    for (long r = 0 ; r < reps ; r++){
+        for (long d = 0 ; d < due_count ; d++)
+            TTDelay_get_task(due_index[d])->uiCurrentPriority = due_priority[d];
+        TTDelay_adjust_priority();
+    }
+    return reps;
+}
+#endif
+
+/* repeats the pass with twice the repetitions until it takes min_ns, returns
+ * ns and tsc ticks per unit counted by the pass */
+static void bench_measure(bench_pass_t pass, double min_ns, double* ns, double* tsc) {
+    for (long reps = 1 ; ; reps *= 2){
+        double   start     = bench_now_ns();
+        uint64_t tsc_start = bench_tsc();
+        long     units     = pass(reps);
+        double   duration  = bench_now_ns() - start;
+        if ((duration >= min_ns) || (reps >= (1L << 30))){
+            *ns  = duration / units;
+            *tsc = (double)(bench_tsc() - tsc_start) / units;
+            return;
+        }
+    }
+}
+
+static void bench_print(const char* bench, long tasks, uint16_t permille, int distribution, double ns, double tsc) {
+    printf("%s,%s,%d,%d,%d,%ld,%u,%s,%.2f,%.1f\n", bench, ENGINE_NAME, TT_ENABLE_TASK_AGING, CPU_MONITOR,
+        TT_TASK_COUNT_MAX, tasks, permille, priority_names[distribution], ns, tsc);
+}
+
+static void bench_run(long tasks, uint16_t permille, int distribution, double min_ns) {
+    double ns, tsc;
+
+    TTDelay_reset();
+    random_state = 1;
+    max_delay    = permille ? 2000 / permille - 1 : 1;
+    for (long i = 0 ; i < tasks ; i++){
+        benchmark_time = BENCH_START_TIME + (permille ? bench_random() % max_delay : BENCH_WAIT_TIME);
+        TTDelay_create_task(bench_task, NULL, NULL, bench_priority(distribution, i, tasks));
+    }
+    benchmark_time = BENCH_START_TIME;
+    bench_pass_run(16);
+    bench_measure(bench_pass_run, min_ns, &ns, &tsc);
+    bench_print("run", tasks, permille, distribution, ns, tsc);
+}
+
+static void bench_passes(long tasks, uint16_t permille, int distribution, double min_ns) {
+    double ns, tsc;
+
+    TTDelay_reset();
+    random_state = 1;
+    due_count    = 0;
+    for (long i = 0 ; i < tasks ; i++){
+        uint8_t priority = bench_priority(distribution, i, tasks);
+        int     due      = bench_is_due(i, permille);
+        benchmark_time   = BENCH_START_TIME + (due ? 0 : BENCH_WAIT_TIME);
+        TTDelay_create_task(bench_idle_task, NULL, NULL, priority);
+        if (due){
+            due_index[due_count]      = TTDelay_get_last_created();
+            due_priority[due_count++] = priority;
+        }
+    }
+    benchmark_time = BENCH_START_TIME;
+    TTDelay_find_due_tasks();
+    bench_measure(bench_pass_find_due, min_ns, &ns, &tsc);
+    bench_print("find_due", tasks, permille, distribution, ns, tsc);
+
+#if TT_ENABLE_TASK_AGING
+    double restore_ns, restore_tsc;
+    bench_measure(bench_pass_restore, min_ns, &restore_ns, &restore_tsc);
+    bench_measure(bench_pass_adjust, min_ns, &ns, &tsc);
+    bench_print("adjust_priority", tasks, permille, distribution,
+        (ns > restore_ns) ? ns - restore_ns : 0, (tsc > restore_tsc) ? tsc - restore_tsc : 0);
+#endif
+}
+
+int main(int argc, char** argv) {
+    long   max_tasks = (argc > 1) ? atol(argv[1]) : TT_TASK_COUNT_MAX;
+    double min_ns    = ((argc > 2) ? atof(argv[2]) : 2) * 1e6;
+
+    if ((max_tasks < 1) || (max_tasks > TT_TASK_COUNT_MAX)){
+        fprintf(stderr, "built for 1..%d tasks\n", TT_TASK_COUNT_MAX);
+        return 1;
+    }
+    printf("bench,engine,aging,cpu_monitor,task_max,tasks,due_permille,priorities,ns,tsc\n");
+    for (long tasks = 1 ; ; tasks = (tasks * 2 < max_tasks) ? tasks * 2 : max_tasks){
+        for (unsigned int p = 0 ; p < sizeof(due_permilles) / sizeof(due_permilles[0]) ; p++){
+            for (int distribution = 0 ; distribution < 4 ; distribution++){
+                bench_run(tasks, due_permilles[p], distribution, min_ns);
+                bench_passes(tasks, due_permilles[p], distribution, min_ns);
+            }
+        }
+        if (tasks == max_tasks)
+            break;
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+/**
+ * @file      bench_pool.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * runs the same periodic task set serially (TTDelay_run) and on a worker pool
+ * (TTDelay_pool_run) and compares how many periods were completed.
+ *
+ * Every task busy waits for TT_BENCH_WORK_US microseconds and has a period of
+ * TT_BENCH_PERIOD_US, so the task set needs more than one core. One tick of
+ * the TTDelay timer is one microsecond of wall clock time. The benchmark also
+ * checks that no task is ever started while it is still running.
+ *
+ *     bench_pool <tasks> <workers> [milliseconds]
+ *
+ * with 0 workers the tasks are run by TTDelay_run().
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "TTDelay_pool.h"
+
+#define TT_BENCH_WORK_US        200
+#define TT_BENCH_PERIOD_US      1000
+
+uint32_t        benchmark_time;
+static TTDelay_pool_t pool;
+static volatile int   running[ TT_TASK_COUNT_MAX ];
+static volatile int   overlap_count;
+static uint64_t       run_count[ TT_TASK_COUNT_MAX ];
+
+uint32_t bench_ticks(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(ts.tv_sec * 1000000ull + ts.tv_nsec / 1000);
+}
+
+static void bench_task(void* in, void* out) {
+    int      id    = (int)(intptr_t)in;
+    uint32_t start = bench_ticks();
+    if (__sync_fetch_and_add(&running[id], 1))
+        __sync_fetch_and_add(&overlap_count, 1);
+    while (bench_ticks() - start < TT_BENCH_WORK_US)
+        ;
+    run_count[id]++;
+    __sync_fetch_and_sub(&running[id], 1);
+}
+
+int main(int argc, char** argv) {
+    long     tasks    = (argc > 1) ? atol(argv[1]) : 16;
+    int      workers  = (argc > 2) ? atoi(argv[2]) : 4;
+    long     duration = (argc > 3) ? atol(argv[3]) : 1000;
+    uint64_t runs = 0, expected;
+    uint32_t end;
+    TT_TIMER_TYPE longest = 0;
+
+    if ((tasks < 1) || (tasks > TT_TASK_COUNT_MAX)){
+        fprintf(stderr, "1..%d tasks\n", TT_TASK_COUNT_MAX);
+        return 1;
+    }
+    benchmark_time = bench_ticks();
+    for (long i = 0 ; i < tasks ; i++){
+        TTDelay_create_task_periodic(bench_task, (void*)(intptr_t)i, NULL, i % 256, TT_BENCH_PERIOD_US);
+    }
+    if (workers && (TTDelay_pool_start(&pool, TTDelay_get_current_instance(), workers) != TT_OK)){
+        fprintf(stderr, "could not start %d workers\n", workers);
+        return 1;
+    }
+
+    end = benchmark_time + duration * 1000;
+    while ((int32_t)(end - benchmark_time) > 0){
+        benchmark_time = bench_ticks();
+        if (workers)
+            TTDelay_pool_run(&pool);
+        else
+            TTDelay_run();
+    }
+    if (workers)
+        TTDelay_pool_stop(&pool);
+
+    for (long i = 0 ; i < tasks ; i++){
+        runs += run_count[i];
+        if (TTDelay_get_task(i)->uiLongestExecuteDuration > longest)
+            longest = TTDelay_get_task(i)->uiLongestExecuteDuration;
+    }
+    expected = tasks * duration * 1000 / TT_BENCH_PERIOD_US;
+    printf("%4ld tasks %2d workers %8llu runs (%5.1f%% of periods) longest %5u us, %d overlaps\n",
+        tasks, workers, (unsigned long long)runs, 100.0 * runs / expected,
+        (unsigned)longest, overlap_count);
+    return overlap_count != 0;
+}
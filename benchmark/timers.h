@@ -0,0 +1,27 @@
+/**
+ * @file      timers.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * timer functions for the benchmarks, TTDelay_config.h includes this instead
+ * of the hardware timers. the benchmarks move the time by themselves.
+ */
+
+#ifndef __BENCHMARK_TIMERS_H
+#define __BENCHMARK_TIMERS_H
+
+#include <stdint.h>
+
+extern uint32_t benchmark_time;
+uint32_t bench_ticks(void);   // wall clock in us, bench_pool only
+
+#define GetSysTick()            (benchmark_time)
+#ifdef TT_BENCH_CPU_TICKS
+uint32_t bench_read_reset_ticks(void);  // time stamp counter, bench_overhead only
+#define ReadResetCpuLoadTick()  bench_read_reset_ticks()
+#else
+#define ReadResetCpuLoadTick()  (0)
+#endif
+
+#endif
@@ -0,0 +1,31 @@
+/**
+ * @file      timers.h
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * virtual clock for the simulation, TTDelay_config.h includes this instead of
+ * the hardware timers. sim_cpu counts TT_READ_RST_TICK_FUNC ticks and only moves
+ * when a task consumes time (sim_consume) or the simulation jumps to the next
+ * due task (sim_idle_until), TT_TIMER_FUNC is derived from it.
+ */
+
+#ifndef __SIMULATION_TIMERS_H
+#define __SIMULATION_TIMERS_H
+
+#include <stdint.h>
+
+// TT_READ_RST_TICK_FUNC ticks per TT_TIMER_FUNC tick (1 us resolution with 1 ms ticks)
+#ifndef SIM_TICKS_PER_TIMER_TICK
+#define SIM_TICKS_PER_TIMER_TICK    1000
+#endif
+
+extern uint64_t sim_cpu;
+uint32_t sim_read_reset_ticks(void);
+void     sim_consume(uint32_t uiTicks);
+void     sim_idle_until(uint32_t uiTime);
+
+#define GetSysTick()                ((uint32_t)(sim_cpu / SIM_TICKS_PER_TIMER_TICK))
+#define ReadResetCpuLoadTick()      sim_read_reset_ticks()
+
+#endif
@@ -0,0 +1,179 @@
+/**
+ * @file      tt_sim.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * discrete event simulation of a task set on the host. The scheduler runs
+ * unchanged on a virtual clock (see timers.h): a task moves the clock forward by
+ * its modelled execution time and when nothing is due the clock jumps straight
+ * to the next execute time, so days of operation take seconds or less.
+ *
+ *     tt_sim <task file> [ticks] [seed]
+ *
+ * ticks is the simulated time in TT_TIMER_FUNC ticks (default: one day of 1 ms
+ * ticks). The task file has one periodic task per line, # starts a comment:
+ *
+ *     <name> <period> <priority> <cost> [jitter] [deadline]
+ *
+ * period and deadline (default: the period) are TT_TIMER_FUNC ticks, cost and
+ * jitter TT_READ_RST_TICK_FUNC ticks (SIM_TICKS_PER_TIMER_TICK per timer tick).
+ * A run takes cost plus a random 0..jitter ticks. The report shows the runs,
+ * CPU share, lateness and missed periods of every task as recorded by TTDelay
+ * itself and the result of the schedulability check (TT_ADMISSION_WARN).
+ * tt_sim_edf is built with TT_POLICY_EDF.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "TTDelay.h"
+
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    #define POLICY_NAME "edf"
+#else
+    #define POLICY_NAME "priority + aging"
+#endif
+
+typedef struct sim_task_t {
+    char            acName[32];
+    uint32_t        uiPeriod;
+    uint32_t        uiDeadline;
+    uint32_t        uiCost;
+    uint32_t        uiJitter;
+    unsigned int    uiPriority;
+    uint64_t        uiRuns;
+} sim_task_t;
+
+uint64_t            sim_cpu;
+static uint64_t     sim_cpu_read;
+static uint32_t     random_state = 1;
+static sim_task_t   sim_tasks[ TT_TASK_COUNT_MAX ];
+
+/* ticks since the last call, TT_READ_RST_TICK_FUNC */
+uint32_t sim_read_reset_ticks(void) {
+    uint32_t uiTicks = (uint32_t)(sim_cpu - sim_cpu_read);
+    sim_cpu_read = sim_cpu;
+    return uiTicks;
+}
+
+/* a task runs for uiTicks */
+void sim_consume(uint32_t uiTicks) {
+    sim_cpu += uiTicks;
+}
+
+/* nothing to do until TT_TIMER_FUNC reaches uiTime */
+void sim_idle_until(uint32_t uiTime) {
+    uint64_t uiTarget = (uint64_t)uiTime * SIM_TICKS_PER_TIMER_TICK;
+    // uiTime may have wrapped around 32 bit
+    while (uiTarget + ((uint64_t)1 << 32) * SIM_TICKS_PER_TIMER_TICK <= sim_cpu)
+        uiTarget += ((uint64_t)1 << 32) * SIM_TICKS_PER_TIMER_TICK;
+    if (uiTarget > sim_cpu)
+        sim_cpu = uiTarget;
+}
+
+static uint32_t sim_random(void) {
+    random_state = random_state * 1103515245u + 12345u;
+    return random_state >> 8;
+}
+
+static void sim_task(void* in, void* out) {
+    sim_task_t* task = (sim_task_t*)in;
+    task->uiRuns++;
+    sim_consume(task->uiCost + (task->uiJitter ? sim_random() % (task->uiJitter + 1) : 0));
+}
+
+static int sim_load(const char* path) {
+    char  line[256];
+    int   count = 0;
+    FILE* in = fopen(path, "r");
+
+    if (!in){
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in)){
+        sim_task_t* task = &sim_tasks[count];
+        int fields;
+        if (strchr(line, '#'))
+            *strchr(line, '#') = 0;
+        task->uiJitter   = 0;
+        task->uiDeadline = 0;
+        fields = sscanf(line, "%31s %u %u %u %u %u", task->acName, &task->uiPeriod, &task->uiPriority,
+            &task->uiCost, &task->uiJitter, &task->uiDeadline);
+        if (fields <= 0)
+            continue;
+        if ((fields < 4) || !task->uiPeriod || (task->uiPriority > 255)){
+            fprintf(stderr, "%s: <name> <period> <priority> <cost> [jitter] [deadline] expected: %s", path, line);
+            fclose(in);
+            return -1;
+        }
+        if (!task->uiDeadline)
+            task->uiDeadline = task->uiPeriod;
+        if (++count == TT_TASK_COUNT_MAX)
+            break;
+    }
+    fclose(in);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    uint64_t ticks = (argc > 2) ? strtoull(argv[2], 0, 0) : 86400000ull;
+    int      count;
+    double   wall;
+    struct timespec start, end;
+
+    if (argc < 2){
+        fprintf(stderr, "usage: %s <task file> [ticks] [seed]\n", argv[0]);
+        return 1;
+    }
+    if (argc > 3)
+        random_state = (uint32_t)atol(argv[3]);
+    count = sim_load(argv[1]);
+    if (count <= 0)
+        return 1;
+
+    for (int i = 0 ; i < count ; i++){
+        sim_task_t* task = &sim_tasks[i];
+        TTDelay_create_task_wcet(sim_task, task, NULL, (uint8_t)task->uiPriority, task->uiPeriod, task->uiCost + task->uiJitter);
+        TTDelay_get_task(i)->uiDeadline = task->uiDeadline;
+    }
+    TTDelay_check_schedulable();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    while (sim_cpu < ticks * SIM_TICKS_PER_TIMER_TICK){
+        TT_TIMER_TYPE idle;
+        TTDelay_run();
+        idle = TTDelay_get_remaining_idle_time();
+        if (idle == TT_IDLE_FOREVER)
+            break;
+        if (idle)
+            sim_idle_until(GetSysTick() + idle);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    wall = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    TTDelay_calculate_cpu_usage();
+
+    printf("%s: %llu ticks simulated in %.1f ms, policy %s\n", argv[1],
+        (unsigned long long)(sim_cpu / SIM_TICKS_PER_TIMER_TICK), wall, POLICY_NAME);
+    printf("%-16s %8s %5s %10s %7s %8s %8s %8s %8s %8s\n", "task", "period", "prio", "runs",
+        "cpu %", "late min", "avg", "p99", "max", "missed");
+    for (int i = 0 ; i < count ; i++){
+        TTDelay_lateness_t* lateness = TTDelay_get_lateness_pointer(i);
+        printf("%-16s %8u %5u %10llu %7.2f %8lu %8lu %8lu %8lu %8lu\n", sim_tasks[i].acName,
+            sim_tasks[i].uiPeriod, sim_tasks[i].uiPriority, (unsigned long long)sim_tasks[i].uiRuns,
+            100.0 * TTDelay_get_cpu_usage_pointer()->uiTaskUsage[i] / TT_CPU_USAGE_ONE,
+            (unsigned long)lateness->uiMin, (unsigned long)TTDelay_get_lateness_avg(i),
+            (unsigned long)TTDelay_get_lateness_percentile(i, 990), (unsigned long)lateness->histogram.uiMax,
+            (unsigned long)lateness->uiMissedPeriods);
+    }
+    printf("idle %.2f %%, utilization (WCET / period) %.2f %%, ",
+        100.0 * TTDelay_get_idle_time_q16() / TT_CPU_USAGE_ONE,
+        100.0 * TTDelay_get_admission_pointer()->uiUtilization / TT_CPU_USAGE_ONE);
+    if (TTDelay_get_admission_pointer()->iFailedTask < 0)
+        printf("schedulability check passed\n");
+    else
+        printf("schedulability check: %s may miss its deadline\n", sim_tasks[TTDelay_get_admission_pointer()->iFailedTask].acName);
+    return 0;
+}
@@ -0,0 +1,138 @@
+/**
+ * @file      tt_table.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * offline schedule table generator (TT_SCHEDULE_TABLE). Reads a task file of
+ * tt_sim, creates the tasks in the same order and prints the table of one
+ * hyperperiod computed by TTDelay_table_generate() as C source, to be compiled
+ * into the target and run with TTDelay_table_start() / TTDelay_run_table():
+ *
+ *     tt_table <task file> [name] > schedule_table.h
+ *
+ * The slot task numbers are the task indices, the target has to create the
+ * tasks in the order of the file. The costs are used to check the table: the
+ * report on stderr lists per task the latest start after its offset when every
+ * run takes cost + jitter, and the busiest hyperperiod share. A start later
+ * than the period of the task is reported as error (exit code 2).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "TTDelay.h"
+
+#define TABLE_SLOTS_MAX     (1 << 20)
+
+typedef struct table_task_t {
+    char            acName[32];
+    uint32_t        uiPeriod;
+    uint32_t        uiCost;
+    uint32_t        uiJitter;
+    unsigned int    uiPriority;
+    uint64_t        uiLatestStart;      // CPU ticks after the offset
+} table_task_t;
+
+uint64_t            sim_cpu;
+static table_task_t tasks[ TT_TASK_COUNT_MAX ];
+static TTDelay_slot_t slots[ TABLE_SLOTS_MAX ];
+
+// the tasks are not run, the clock stays at 0
+uint32_t sim_read_reset_ticks(void) {
+    return 0;
+}
+
+static void table_task(void* in, void* out) {
+}
+
+static int table_load(const char* path) {
+    char  line[256];
+    int   count = 0;
+    FILE* in = fopen(path, "r");
+
+    if (!in){
+        perror(path);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in)){
+        table_task_t* task = &tasks[count];
+        int fields;
+        if (strchr(line, '#'))
+            *strchr(line, '#') = 0;
+        task->uiJitter = 0;
+        fields = sscanf(line, "%31s %u %u %u %u", task->acName, &task->uiPeriod, &task->uiPriority,
+            &task->uiCost, &task->uiJitter);
+        if (fields <= 0)
+            continue;
+        if ((fields < 4) || !task->uiPeriod || (task->uiPriority > 255)){
+            fprintf(stderr, "%s: <name> <period> <priority> <cost> [jitter] expected: %s", path, line);
+            fclose(in);
+            return -1;
+        }
+        if (++count == TT_TASK_COUNT_MAX)
+            break;
+    }
+    fclose(in);
+    return count;
+}
+
+int main(int argc, char** argv) {
+    const char*   name = (argc > 2) ? argv[2] : "tt_schedule";
+    TT_TIMER_TYPE hyperperiod;
+    uint64_t      busy = 0, hyper_ticks, end = 0;
+    int           count, slot_count, late = 0;
+
+    if (argc < 2){
+        fprintf(stderr, "usage: %s <task file> [name]\n", argv[0]);
+        return 1;
+    }
+    count = table_load(argv[1]);
+    if (count <= 0)
+        return 1;
+    for (int i = 0 ; i < count ; i++)
+        TTDelay_create_task_periodic(table_task, NULL, NULL, (uint8_t)tasks[i].uiPriority, tasks[i].uiPeriod);
+    slot_count = TTDelay_table_generate(slots, TABLE_SLOTS_MAX, &hyperperiod);
+    if (slot_count < 0){
+        fprintf(stderr, "%s: hyperperiod too long or more than %d slots\n", argv[1], TABLE_SLOTS_MAX);
+        return 1;
+    }
+
+    // worst case: every run takes cost + jitter, the slots run back to back
+    hyper_ticks = (uint64_t)hyperperiod * SIM_TICKS_PER_TIMER_TICK;
+    for (int s = 0 ; s < slot_count ; s++){
+        table_task_t* task  = &tasks[slots[s].uiTask];
+        uint64_t      start = (uint64_t)slots[s].uiOffset * SIM_TICKS_PER_TIMER_TICK;
+        if (end < start)
+            end = start;
+        if (end - start > task->uiLatestStart)
+            task->uiLatestStart = end - start;
+        end  += task->uiCost + task->uiJitter;
+        busy += task->uiCost + task->uiJitter;
+    }
+
+    printf("/* schedule table generated by tt_table from %s, create the tasks in this order:\n", argv[1]);
+    for (int i = 0 ; i < count ; i++)
+        printf(" * %4d  %s\n", i, tasks[i].acName);
+    printf(" */\n#define %s_HYPERPERIOD  %lu\n#define %s_SLOTS        %d\n\n",
+        name, (unsigned long)hyperperiod, name, slot_count);
+    printf("static const TTDelay_slot_t %s[ %d ] = {\n", name, slot_count);
+    for (int s = 0 ; s < slot_count ; s++)
+        printf("    { %6lu, %4u },\n", (unsigned long)slots[s].uiOffset, (unsigned int)slots[s].uiTask);
+    printf("};\n");
+
+    fprintf(stderr, "%s: %d tasks, hyperperiod %lu ticks, %d slots, %.2f %% busy\n", argv[1], count,
+        (unsigned long)hyperperiod, slot_count, 100.0 * busy / hyper_ticks);
+    fprintf(stderr, "%-16s %8s %14s\n", "task", "period", "latest start");
+    for (int i = 0 ; i < count ; i++){
+        double latest = (double)tasks[i].uiLatestStart / SIM_TICKS_PER_TIMER_TICK;
+        int    missed = latest >= tasks[i].uiPeriod;
+        fprintf(stderr, "%-16s %8u %14.3f%s\n", tasks[i].acName, tasks[i].uiPeriod, latest, missed ? "  misses its period" : "");
+        late |= missed;
+    }
+    if (end > hyper_ticks){
+        fprintf(stderr, "the last slots run into the next hyperperiod\n");
+        late = 1;
+    }
+    return late ? 2 : 0;
+}
@@ -0,0 +1,180 @@
+/**
+ * @file      tt_trace2json.c
+ * @authors   Lars Heinrichs
+ * @copyright 2019, MIT License, Lars Heinrichs
+ *
+ * @brief
+ * converts a TTDelay trace capture (TT_TRACE) to the Chrome trace event JSON
+ * format, which can be opened in Perfetto (ui.perfetto.dev) or chrome://tracing.
+ *
+ * A capture is a TTDelay_trace_header_t followed by the events, as filled in by
+ * TTDelay_trace_read_r(), written in the byte order of the host (little endian
+ * on most targets). Runs on the host, does not need the TTDelay sources:
+ *
+ *     cc -o tt_trace2json tt_trace2json.c
+ *     tt_trace2json [-f hz] [-t us] capture.bin > capture.json
+ *
+ * -f: ticks per second of TT_READ_RST_TICK_FUNC, the events are placed with
+ *     these ticks then (recommended)
+ * -t: microseconds per TT_TIMER_FUNC tick (default 1000), used without -f
+ *
+ * Every task gets its own track with one slice per run, idle time is shown on
+ * track 0. Rescheduling, aging and application events are instant events.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+// has to match TTDelay.h
+#define TT_TRACE_TASK_START    1
+#define TT_TRACE_TASK_END      2
+#define TT_TRACE_FROM_NOW      3
+#define TT_TRACE_FROM_LAST     4
+#define TT_TRACE_SET_FUNCTION  5
+#define TT_TRACE_AGING         6
+#define TT_TRACE_IDLE          7
+#define TT_TRACE_USER          16
+#define TT_TRACE_NO_TASK       0xFFFF
+#define TT_TRACE_VERSION       1
+
+typedef struct {
+    uint32_t        uiTicks;
+    uint32_t        uiTime;
+    uint32_t        uiArg;
+    uint16_t        uiTask;
+    uint8_t         uiType;
+    uint8_t         uiReserved;
+} trace_event_t;
+
+typedef struct {
+    char            acMagic[4];
+    uint16_t        uiVersion;
+    uint8_t         uiEventSize;
+    uint8_t         uiTimerBits;
+    uint32_t        uiCount;
+    uint32_t        uiLost;
+} trace_header_t;
+
+static double       tick_us;            // microseconds per TT_READ_RST_TICK_FUNC tick, 0: not known
+static double       time_us = 1000.0;   // microseconds per TT_TIMER_FUNC tick
+static int          first_event = 1;
+static double       start_ts[TT_TRACE_NO_TASK + 1];
+static uint8_t      task_seen[TT_TRACE_NO_TASK + 1];
+
+static void json_begin(const char* name, char ph, double ts, int tid) {
+    printf("%s\n{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d",
+        first_event ? "" : ",", name, ph, ts, tid);
+    first_event = 0;
+}
+
+static void json_task_name(int tid, uint16_t task) {
+    printf("%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"task %u\"}}",
+        first_event ? "" : ",", tid, task);
+    first_event = 0;
+}
+
+int main(int argc, char** argv) {
+    trace_header_t header;
+    trace_event_t  event;
+    FILE*          in;
+    const char*    path = 0;
+    uint64_t       ticks = 0, time = 0;
+    uint32_t       last_ticks = 0, last_time = 0, time_mask;
+
+    for (int i = 1 ; i < argc ; i++){
+        if (!strcmp(argv[i], "-f") && (i + 1 < argc))
+            tick_us = 1e6 / atof(argv[++i]);
+        else if (!strcmp(argv[i], "-t") && (i + 1 < argc))
+            time_us = atof(argv[++i]);
+        else
+            path = argv[i];
+    }
+    if (!path){
+        fprintf(stderr, "usage: %s [-f hz] [-t us] capture.bin > capture.json\n", argv[0]);
+        return 1;
+    }
+    in = fopen(path, "rb");
+    if (!in){
+        perror(path);
+        return 1;
+    }
+    if ((fread(&header, sizeof(header), 1, in) != 1) || memcmp(header.acMagic, "TTTR", 4)
+    || (header.uiVersion != TT_TRACE_VERSION) || (header.uiEventSize != sizeof(trace_event_t))){
+        fprintf(stderr, "%s: not a TTDelay trace capture (version %d)\n", path, TT_TRACE_VERSION);
+        return 1;
+    }
+    time_mask = (header.uiTimerBits >= 32) ? 0xFFFFFFFF : ((uint32_t)1 << header.uiTimerBits) - 1;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"otherData\":{\"lost\":%u},\"traceEvents\":[", header.uiLost);
+    printf("\n{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"TTDelay\"}},");
+    printf("\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"idle\"}}");
+    first_event = 0;
+
+    for (uint32_t n = 0 ; (n < header.uiCount) && (fread(&event, sizeof(event), 1, in) == 1) ; n++){
+        double ts;
+        int    tid = (event.uiTask == TT_TRACE_NO_TASK) ? 0 : event.uiTask + 1;
+
+        // both clocks wrap, follow them from event to event
+        if (n){
+            ticks += (uint32_t)(event.uiTicks - last_ticks);
+            time  += (event.uiTime - last_time) & time_mask;
+        }
+        last_ticks = event.uiTicks;
+        last_time  = event.uiTime;
+        ts = tick_us ? ticks * tick_us : time * time_us;
+
+        if (tid && !task_seen[event.uiTask]){
+            task_seen[event.uiTask] = 1;
+            json_task_name(tid, event.uiTask);
+        }
+
+        switch (event.uiType){
+        case TT_TRACE_TASK_START:
+            start_ts[event.uiTask] = ts;
+            json_begin("start", 'i', ts, tid);
+            printf(",\"s\":\"t\",\"args\":{\"due\":%u,\"late\":%u}}", event.uiArg,
+                (event.uiTime - event.uiArg) & time_mask);
+            break;
+        case TT_TRACE_TASK_END: {
+            // the run ends now and took uiArg ticks, the timer is too coarse for that
+            double begin = tick_us ? ts - event.uiArg * tick_us : start_ts[event.uiTask];
+            char   name[16];
+            snprintf(name, sizeof(name), "task %u", event.uiTask);
+            json_begin(name, 'X', begin, tid);
+            printf(",\"dur\":%.3f,\"args\":{\"ticks\":%u}}", ts - begin, event.uiArg);
+            break;
+        }
+        case TT_TRACE_IDLE:
+            if (!tick_us || !event.uiArg)
+                break;
+            json_begin("idle", 'X', ts - event.uiArg * tick_us, 0);
+            printf(",\"dur\":%.3f}", event.uiArg * tick_us);
+            break;
+        case TT_TRACE_FROM_NOW:
+        case TT_TRACE_FROM_LAST:
+            json_begin((event.uiType == TT_TRACE_FROM_NOW) ? "from_now" : "from_last", 'i', ts, tid);
+            printf(",\"s\":\"t\",\"args\":{\"next\":%u}}", event.uiArg);
+            break;
+        case TT_TRACE_SET_FUNCTION:
+            json_begin("set_next_function", 'i', ts, tid);
+            printf(",\"s\":\"t\",\"args\":{\"func\":\"0x%08x\"}}", event.uiArg);
+            break;
+        case TT_TRACE_AGING:
+            json_begin("aging", 'i', ts, tid);
+            printf(",\"s\":\"t\",\"args\":{\"priority\":%u}}", event.uiArg);
+            break;
+        default: {
+            char name[16];
+            snprintf(name, sizeof(name), "event %u", event.uiType);
+            json_begin(name, 'i', ts, tid);
+            printf(",\"s\":\"t\",\"args\":{\"arg\":%u}}", event.uiArg);
+            break;
+        }
+        }
+    }
+    printf("\n]}\n");
+    fclose(in);
+    return 0;
+}
@@ -257,6 +257,59 @@ void test_schedule_with_timer_overflow_direct(){
     TEST_ASSERT_EQUAL(3, delay_test_var);
 }
 
+/* *****************************************************************************
+ *  THIS SECTION TESTS TASKS WAITING FOR DIFFERENT TIMES. THIS IS WHERE THE
+ *  SCHEDULER ENGINES (TT_SCHEDULER_ENGINE) DIFFER, RESULTS MUST NOT.
+ * *****************************************************************************/
+void delay_long_increase(void* in, void* out){
+    *((int*)out) += 10;
+    TTDelay_from_now(10*DELAY_TIME);
+}
+
+// a task waiting for a long time must not hide a task that is due earlier
+void test_short_delay_task_runs_before_long_delay_task(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task( delay_long_increase, NULL, &delay_test_var, 10);
+    TTDelay_create_task( delay_increase,      NULL, &delay_test_var, 50);
+
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run());
+    TEST_ASSERT_EQUAL(10, delay_test_var);
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
+    TEST_ASSERT_EQUAL(11, delay_test_var);
+
+    // only the short delay task is due, several times in a row
+    for (int i = 1 ; i < 5 ; i++){
+        GetSysTick_ExpectAndReturn(i * DELAY_TIME);
+        TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
+        TEST_ASSERT_EQUAL(11 + i, delay_test_var);
+    }
+    TEST_ASSERT_EQUAL(10*DELAY_TIME, TTDelay_get_next_schedule_time(0));
+}
+
+// polling while nothing is due must not run or reorder anything
+void test_idle_polls_run_nothing(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    for (int i = 0 ; i < 3 ; i++){
+        GetSysTick_ExpectAndReturn(0);
+        TTDelay_run();
+    }
+    output_value = 0;
+    for (int i = 1 ; i < DELAY_TIME ; i += 7){
+        GetSysTick_ExpectAndReturn(i);
+        TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
+        TEST_ASSERT_EQUAL(0, output_value);
+    }
+    // all three are due again, highest priority first
+    GetSysTick_ExpectAndReturn(DELAY_TIME);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run());
+    TEST_ASSERT_EQUAL(2, output_value);
+}
+
 /* *****************************************************************************
  *  THIS SECTION TESTS CHECK FUNCTION POINTER CHANGES
  * *****************************************************************************/
@@ -469,16 +522,312 @@ void test_full_run_cycle_with_rescheduled_high_priority(){
     // at this point, the first two tasks should be rescheduled!
     GetSysTick_ExpectAndReturn(DELAY_TIME + 1);
     TTDelay_run();
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // the task waiting since 0 has the earliest deadline
+    TEST_ASSERT_EQUAL(10, output_value);
+#else
     TEST_ASSERT_EQUAL(2, output_value);
+#endif
 
     GetSysTick_ExpectAndReturn(DELAY_TIME + 2);
     TTDelay_run();
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TEST_ASSERT_EQUAL(2, output_value);
+#else
     TEST_ASSERT_EQUAL(5, output_value);
+#endif
 
     GetSysTick_ExpectAndReturn(DELAY_TIME + 3);
     TTDelay_run();
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TEST_ASSERT_EQUAL(5, output_value);
+#else
+    TEST_ASSERT_EQUAL(10, output_value);
+#endif
+
+}
+
+// the lowest possible priority must still be run when it is the only due task
+void test_full_run_cycle_priority_255(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(priority_5, NULL, &output_value, 255);
+    GetSysTick_ExpectAndReturn(1);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
+    TEST_ASSERT_EQUAL(5, output_value);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_next_scheduled());
+}
+
+// all due tasks in priority order, as handed out by the worker pool
+void test_get_due_tasks_in_priority_order(){
+    TT_TASK_INDEX_TYPE due[TT_TASK_COUNT_MAX];
+    create_priority_tasks();
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_EQUAL(3, TTDelay_get_due_tasks_r(TTDelay_get_current_instance(), due, TT_TASK_COUNT_MAX));
+    TEST_ASSERT_EQUAL(2, due[0]);
+    TEST_ASSERT_EQUAL(1, due[1]);
+    TEST_ASSERT_EQUAL(0, due[2]);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_due_tasks_r(TTDelay_get_current_instance(), due, 2));
+}
+
+// a task that was handed to a worker must not be found again until it ended
+void test_running_task_is_not_due(){
+    TTDelay_t* tt = TTDelay_get_current_instance();
+    create_priority_tasks();
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_find_due_tasks();
+    TTDelay_task_begin_r(tt, 2);
+
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 2);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_FALSE(TTDelay_is_due(2));
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task_scheduled_count_r(tt));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_next_scheduled());
+
+    TTDelay_task_execute_r(tt, 2);
+    TEST_ASSERT_EQUAL(2, output_value);
+    TTDelay_task_end_r(tt, 2, 7);
+    TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_next_schedule_time(2));
+    TEST_ASSERT_EQUAL(7, TTDelay_get_task(2)->uiLongestExecuteDuration);
+
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 2);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_TRUE(TTDelay_is_due(2));
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // the other two are due since 0, before task 2
+    TEST_ASSERT_EQUAL(1, TTDelay_get_next_scheduled());
+#else
+    TEST_ASSERT_EQUAL(2, TTDelay_get_next_scheduled());
+#endif
+}
+
+// all due tasks are run in priority order by a single call
+void test_run_batch_all_due_tasks(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    GetSysTick_ExpectAndReturn(1);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_batch(0, 0));
+    // lowest priority is run last
+    TEST_ASSERT_EQUAL(10, output_value);
+    for (int i = 0 ; i < 3 ; i++){
+        TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_next_schedule_time(i));
+    }
+    GetSysTick_ExpectAndReturn(2);
+    output_value = 0;
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_batch(0, 0));
+    TEST_ASSERT_EQUAL(0, output_value);
+}
+
+// tasks left over because of the task limit are aged and run by the next batch
+void test_run_batch_task_limit(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(priority_10, NULL, &output_value, 100);
+    TTDelay_create_task(priority_5,  NULL, &output_value, 50);
+    TTDelay_create_task(priority_2,  NULL, &output_value, 20);
+
+    GetSysTick_ExpectAndReturn(1);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run_batch(2, 0));
+    TEST_ASSERT_EQUAL(5, output_value);
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // no aging with deadlines
+    TEST_ASSERT_EQUAL(100, TTDelay_get_task(0)->uiCurrentPriority);
+#else
+    TEST_ASSERT_EQUAL(99, TTDelay_get_task(0)->uiCurrentPriority);
+#endif
+    TEST_ASSERT_EQUAL(50, TTDelay_get_task(1)->uiCurrentPriority);
+
+    GetSysTick_ExpectAndReturn(2);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_batch(2, 0));
+    TEST_ASSERT_EQUAL(10, output_value);
+    TEST_ASSERT_EQUAL(100, TTDelay_get_task(0)->uiCurrentPriority);
+}
+
+// the time limit is checked before each task, the first task is always run
+void test_run_batch_time_limit(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    GetSysTick_ExpectAndReturn(1);
+    GetSysTick_ExpectAndReturn(2);
+    GetSysTick_ExpectAndReturn(4);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run_batch(0, 3));
+    TEST_ASSERT_EQUAL(5, output_value);
+    TEST_ASSERT_TRUE(TTDelay_is_due(0));
+}
+
+/* ************************************************** */
+void delete_self(void* in, void* out){
+    *((int*)out) += 1;
+    TTDelay_delete_task(TTDelay_get_current_task());
+}
+
+// the slot of a deleted task is reused, other tasks keep their index
+void test_delete_task_reuses_slot(){
+    create_priority_tasks();
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_delete_task(1));
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_delete_task(1));
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task_count());
+    TEST_ASSERT_NULL(TTDelay_get_task(1));
+    TEST_ASSERT_EQUAL(priority_2, TTDelay_get_task(2)->func);
+
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task(led_toggle, NULL, &led_value, 7));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_last_created());
+    TEST_ASSERT_EQUAL(3, TTDelay_get_task_count());
+    TEST_ASSERT_EQUAL(led_toggle, TTDelay_get_task(1)->func);
+    TEST_ASSERT_EQUAL(7, TTDelay_get_task(1)->uiCurrentPriority);
+}
+
+void test_delete_task_frees_room_for_new_task(){
+    for (int i=0; i < TT_TASK_COUNT_MAX ; i++){
+        GetSysTick_ExpectAndReturn(0);
+        TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task(led_toggle, NULL, &led_value, i));
+    }
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_delete_task(3));
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task(led_toggle, NULL, &led_value, 5));
+    TEST_ASSERT_EQUAL(3, TTDelay_get_last_created());
+    TEST_ASSERT_EQUAL(TT_ERROR_TOO_MANY_TASKS, TTDelay_create_task(led_toggle, NULL, &led_value, 5));
+}
+
+void test_deleted_task_is_not_run(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    TTDelay_delete_task(2);
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_FALSE(TTDelay_is_due(2));
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task_scheduled_count_r(TTDelay_get_current_instance()));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_next_scheduled());
+}
+
+void test_task_deletes_itself(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delete_self, NULL, &delay_test_var, 10);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, delay_test_var);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task_count());
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, delay_test_var);
+}
+
+// a task deleted or suspended while it runs (e.g. on a worker of TTDelay_pool.c)
+// is taken out by TTDelay_task_end_r() on the thread that owns the instance
+void test_running_task_is_taken_out_when_it_ends(){
+    TTDelay_t* tt = TTDelay_get_current_instance();
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_find_due_tasks();
+    TTDelay_task_begin_r(tt, 1);
+    TTDelay_task_begin_r(tt, 2);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_delete_task(1));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_suspend_task(2));
+    TEST_ASSERT_EQUAL(3, TTDelay_get_task_count());
+
+    TTDelay_task_end_r(tt, 1, 0);
+    TTDelay_task_end_r(tt, 2, 0);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task_count());
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 3);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_FALSE(TTDelay_is_due(1));
+    TEST_ASSERT_FALSE(TTDelay_is_due(2));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_task_scheduled_count_r(tt));
+
+    // resumed before it returns: it was never taken out
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 3);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_resume_task(2));
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 4);
+    TTDelay_find_due_tasks();
+    TTDelay_task_begin_r(tt, 2);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_suspend_task(2));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_resume_task(2));
+    TTDelay_task_end_r(tt, 2, 0);
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 5);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_TRUE(TTDelay_is_due(2));
+}
+
+// a suspended task is skipped until it is resumed, then it is due right away
+void test_suspend_and_resume_task(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    create_priority_tasks();
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_suspend_task(2));
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(5, output_value);
+    GetSysTick_ExpectAndReturn(2);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(10, output_value);
+    GetSysTick_ExpectAndReturn(3);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
     TEST_ASSERT_EQUAL(10, output_value);
 
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 3);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_resume_task(2));
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // the other two are behind since DELAY_TIME, they catch up first
+    for (int i = 0 ; i < 4 ; i++){
+        GetSysTick_ExpectAndReturn(DELAY_TIME * 3);
+        TTDelay_run();
+        TEST_ASSERT_NOT_EQUAL(2, output_value);
+    }
+#endif
+    GetSysTick_ExpectAndReturn(DELAY_TIME * 3);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    TEST_ASSERT_EQUAL(DELAY_TIME * 4, TTDelay_get_next_schedule_time(2));
+}
+
+// ticks until the next task is due, used to sleep instead of polling
+void test_remaining_idle_time_no_tasks(){
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_IDLE_FOREVER, TTDelay_get_remaining_idle_time());
+}
+
+void test_remaining_idle_time_until_next_task(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delay_add_from_now, NULL, &delay_test_var, 10);
+    TTDelay_create_task(delay_add_from_now, NULL, &delay_test_var, 20);
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_remaining_idle_time());
+
+    GetSysTick_ExpectAndReturn(10);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run());
+    GetSysTick_ExpectAndReturn(10);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_remaining_idle_time());
+    GetSysTick_ExpectAndReturn(12);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run());
+    // the first task is due at 10 + DELAY_TIME
+    GetSysTick_ExpectAndReturn(20);
+    TEST_ASSERT_EQUAL(DELAY_TIME - 10, TTDelay_get_remaining_idle_time());
+    GetSysTick_ExpectAndReturn(10 + DELAY_TIME);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_remaining_idle_time());
+}
+
+void test_remaining_idle_time_with_timer_overflow(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0xFFFFFFF0);
+    TTDelay_create_task(delay_add_from_now, NULL, &delay_test_var, 10);
+    GetSysTick_ExpectAndReturn(0xFFFFFFF0);
+    TTDelay_run();
+    GetSysTick_ExpectAndReturn(0xFFFFFFF0);
+    TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_remaining_idle_time());
+    // the timer overflowed, TTDelay_run() has to look at the tasks first
+    GetSysTick_ExpectAndReturn(2);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_remaining_idle_time());
+    GetSysTick_ExpectAndReturn(2);
+    TTDelay_run();
+    GetSysTick_ExpectAndReturn(2);
+    TEST_ASSERT_EQUAL(DELAY_TIME - 0x12, TTDelay_get_remaining_idle_time());
 }
 
 /* ************************************************** */
@@ -511,6 +860,246 @@ void test_cpu_usage_calculation(){
     TEST_ASSERT_FLOAT_WITHIN(0.001, 0.05  , cpuUsage->rTtsysUsage);
 }
 
+void test_cpu_usage_q16_survives_32_bit_overflow(){
+    create_priority_tasks(); // create 3 tasks
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_periodic(TTDelay_cpu_usage_monitor, NULL, NULL, 50, 1000);
+
+    // the sum does not fit into 32 bit anymore
+    TTDelay_get_task(0)->timeRunning = 0x80000000u;
+    TTDelay_get_task(1)->timeRunning = 0x40000000u;
+    TTDelay_get_task(2)->timeRunning = 0x40000000u;
+    TTDelay_get_task(3)->timeRunning = 0;
+    TTDelay_set_idle_tick_count(0);
+    TTDelay_set_ttsys_tick_count(0);
+
+    TTDelay_run_task(3);
+
+    TTDelay_cpu_usage_TypDef* cpuUsage = TTDelay_get_cpu_usage_pointer();
+    TEST_ASSERT_UINT32_WITHIN(2, TT_CPU_USAGE_ONE / 2, cpuUsage->uiTaskUsage[0]);
+    TEST_ASSERT_UINT32_WITHIN(2, TT_CPU_USAGE_ONE / 4, cpuUsage->uiTaskUsage[1]);
+    TEST_ASSERT_UINT32_WITHIN(2, TT_CPU_USAGE_ONE / 4, cpuUsage->uiTaskUsage[2]);
+    TEST_ASSERT_EQUAL_UINT32(0, cpuUsage->uiTaskUsage[3]);
+    TEST_ASSERT_EQUAL_UINT32(0, TTDelay_get_idle_time_q16());
+}
+
+void do_nothing(void* in, void* out){
+}
+
+// runs task 0 once, TT_READ_RST_TICK_FUNC measures uiTicks for it
+void run_task_measured(uint16_t uiTicks){
+    ReadResetCpuLoadTick_ExpectAndReturn(0);
+    ReadResetCpuLoadTick_ExpectAndReturn(uiTicks);
+    TTDelay_run_task(0);
+}
+
+void run_exec_time_mix(){
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(do_nothing, NULL, NULL, 5);
+    for (int i = 0 ; i < 97 ; i++)
+        run_task_measured(10);
+    run_task_measured(300);
+    run_task_measured(300);
+    run_task_measured(1000);
+}
+
+void test_exec_histogram_percentiles(){
+    run_exec_time_mix();
+    // bucket upper ends with 4 buckets per power of two: 10 -> 11, 300 -> 319
+    TEST_ASSERT_EQUAL(11,   TTDelay_get_exec_percentile(0, 500));
+    TEST_ASSERT_EQUAL(319,  TTDelay_get_exec_percentile(0, 990));
+    TEST_ASSERT_EQUAL(1000, TTDelay_get_exec_percentile(0, 1000));
+    TEST_ASSERT_EQUAL(0,    TTDelay_get_exec_percentile(1, 500));
+}
+
+void test_exec_histogram_follows_cpu_usage_interval(){
+    run_exec_time_mix();
+    TTDelay_cpu_usage_TypDef* cpuUsage = TTDelay_get_cpu_usage_pointer();
+    TTDelay_calculate_cpu_usage();
+    TTDelay_reset_time_running();
+
+    TEST_ASSERT_EQUAL(11,   cpuUsage->uiTaskExecP50[0]);
+    TEST_ASSERT_EQUAL(319,  cpuUsage->uiTaskExecP99[0]);
+    TEST_ASSERT_EQUAL(1000, cpuUsage->uiTaskExecMax[0]);
+    // the next interval starts empty
+    TEST_ASSERT_EQUAL(0, TTDelay_get_exec_percentile(0, 990));
+    run_task_measured(20);
+    TEST_ASSERT_EQUAL(20, TTDelay_get_exec_percentile(0, 990));
+}
+
+void test_lateness_min_avg_max(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delay_increase, NULL, &delay_test_var, 5);
+
+    GetSysTick_ExpectAndReturn(3);                  // due at 0
+    TTDelay_run();
+    GetSysTick_ExpectAndReturn(3 + DELAY_TIME + 7); // due at 3 + DELAY_TIME
+    TTDelay_run();
+    GetSysTick_ExpectAndReturn(3 + 2 * DELAY_TIME + 8);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(3, delay_test_var);
+
+    TTDelay_lateness_t* lateness = TTDelay_get_lateness_pointer(0);
+    TEST_ASSERT_EQUAL(3, lateness->histogram.uiSamples);
+    TEST_ASSERT_EQUAL(1, lateness->uiMin);
+    TEST_ASSERT_EQUAL(7, lateness->histogram.uiMax);
+    TEST_ASSERT_EQUAL(11 / 3, TTDelay_get_lateness_avg(0));
+    TEST_ASSERT_EQUAL(7, TTDelay_get_lateness_percentile(0, 1000));
+    TEST_ASSERT_EQUAL(0, lateness->uiMissedPeriods);
+}
+
+void test_lateness_counts_missed_periods(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_periodic(delay_periodic_increase, NULL, &delay_test_var, 5, DELAY_TIME);
+
+    // first run: late, but there was no period yet
+    GetSysTick_ExpectAndReturn(10);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(0, TTDelay_get_lateness_pointer(0)->uiMissedPeriods);
+    // due at DELAY_TIME, 2 * DELAY_TIME and 3 * DELAY_TIME. the first two start
+    // after the following period began
+    for (int i = 0 ; i < 3 ; i++){
+        GetSysTick_ExpectAndReturn(3 * DELAY_TIME + 10);
+        TTDelay_run();
+    }
+    TEST_ASSERT_EQUAL(4, delay_test_var);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_lateness_pointer(0)->uiMissedPeriods);
+
+    TTDelay_reset_lateness();
+    TEST_ASSERT_EQUAL(0, TTDelay_get_lateness_pointer(0)->uiMissedPeriods);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_lateness_avg(0));
+}
+
+void test_create_task_deadline(){
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_periodic(led_toggle, NULL, &led_value, 5, DELAY_TIME));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_deadline(led_toggle, NULL, &led_value, 5, DELAY_TIME, 20));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_deadline(led_toggle, NULL, &led_value, 5, 0, 30));
+    // the period is the default deadline of a periodic task
+    TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_task(0)->uiDeadline);
+    TEST_ASSERT_EQUAL(20, TTDelay_get_task(1)->uiDeadline);
+    TEST_ASSERT_EQUAL(TT_TASK_IS_PERIODIC, TTDelay_get_task(1)->uiFlags);
+    TEST_ASSERT_EQUAL(30, TTDelay_get_task(2)->uiDeadline);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task(2)->uiFlags);
+}
+
+void test_policy_picks_priority_or_earliest_deadline(){
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_deadline(led_toggle, NULL, &led_value, 1,   0, 100);
+    TTDelay_create_task_deadline(led_toggle, NULL, &led_value, 200, 0, 10);
+    GetSysTick_ExpectAndReturn(5);
+    TTDelay_find_due_tasks();
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    TEST_ASSERT_EQUAL(1, TTDelay_get_next_scheduled());
+#else
+    TEST_ASSERT_EQUAL(0, TTDelay_get_next_scheduled());
+#endif
+}
+
+void test_admission_rejects_task_set_that_misses_deadlines(){
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_wcet(do_nothing, NULL, NULL, 1, 10, 5));
+    // task 0 could start after the 6 ticks of task 1: 11 > 10
+    TEST_ASSERT_EQUAL(TT_ERROR_NOT_SCHEDULABLE, TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 6));
+    TEST_ASSERT_EQUAL(0, TTDelay_get_admission_pointer()->iFailedTask);
+    TEST_ASSERT_TRUE(TTDelay_get_task(1) == NULL);
+
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // density of task 0: 5 / 10 + 4 / 20 + blocking 4 / 10 > 1
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_ERROR_NOT_SCHEDULABLE, TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 4));
+    TEST_ASSERT_EQUAL(0, TTDelay_get_admission_pointer()->iFailedTask);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 3));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_last_created());
+    TEST_ASSERT_EQUAL(-1, TTDelay_get_admission_pointer()->iFailedTask);
+    // 5 / 10 + 3 / 20
+    TEST_ASSERT_EQUAL((TT_CPU_USAGE_ONE * 13) / 20, TTDelay_get_admission_pointer()->uiUtilization);
+#else
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 4));
+    TEST_ASSERT_EQUAL(1, TTDelay_get_last_created());
+    TEST_ASSERT_EQUAL(-1, TTDelay_get_admission_pointer()->iFailedTask);
+    // 5 / 10 + 4 / 20
+    TEST_ASSERT_EQUAL((TT_CPU_USAGE_ONE * 7) / 10, TTDelay_get_admission_pointer()->uiUtilization);
+#endif
+}
+
+void test_admission_recheck_uses_measured_execution_time(){
+    GetSysTick_ExpectAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_wcet(do_nothing, NULL, NULL, 1, 10, 5);
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    // density of task 0 with 7 ticks: 7 / 10 + 3 / 20 + blocking 3 / 10 > 1
+    TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 3);
+#else
+    TTDelay_create_task_wcet(do_nothing, NULL, NULL, 2, 20, 4);
+#endif
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_check_schedulable());
+
+    run_task_measured(7);
+    TEST_ASSERT_EQUAL(TT_ERROR_NOT_SCHEDULABLE, TTDelay_check_schedulable());
+    TEST_ASSERT_EQUAL(0, TTDelay_get_admission_pointer()->iFailedTask);
+}
+
+void test_trace_records_task_run(){
+    TTDelay_trace_header_t header;
+    TTDelay_trace_event_t  events[8];
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(led_toggle, NULL, &led_value, 5);
+
+    GetSysTick_ExpectAndReturn(4);
+    ReadResetCpuLoadTick_ExpectAndReturn(5);        // idle
+    ReadResetCpuLoadTick_ExpectAndReturn(2);        // ttsys
+    ReadResetCpuLoadTick_ExpectAndReturn(3);        // task
+    TTDelay_run();
+
+    TEST_ASSERT_EQUAL(4, TTDelay_trace_read(&header, events, 8));
+    TEST_ASSERT_EQUAL_MEMORY(TT_TRACE_MAGIC, header.acMagic, 4);
+    TEST_ASSERT_EQUAL(sizeof(TTDelay_trace_event_t), header.uiEventSize);
+    TEST_ASSERT_EQUAL(0, header.uiLost);
+
+    TEST_ASSERT_EQUAL(TT_TRACE_IDLE,       events[0].uiType);
+    TEST_ASSERT_EQUAL(TT_TRACE_NO_TASK,    events[0].uiTask);
+    TEST_ASSERT_EQUAL(5,                   events[0].uiArg);
+    TEST_ASSERT_EQUAL(TT_TRACE_TASK_START, events[1].uiType);
+    TEST_ASSERT_EQUAL(0,                   events[1].uiTask);
+    TEST_ASSERT_EQUAL(4,                   events[1].uiTime);
+    TEST_ASSERT_EQUAL(0,                   events[1].uiArg);
+    TEST_ASSERT_EQUAL(TT_TRACE_FROM_LAST,  events[2].uiType);
+    TEST_ASSERT_EQUAL(DELAY_TIME,          events[2].uiArg);
+    TEST_ASSERT_EQUAL(7,                   events[2].uiTicks);
+    TEST_ASSERT_EQUAL(TT_TRACE_TASK_END,   events[3].uiType);
+    TEST_ASSERT_EQUAL(3,                   events[3].uiArg);
+    TEST_ASSERT_EQUAL(10,                  events[3].uiTicks);
+}
+
+void test_trace_ring_keeps_newest_events(){
+    static TTDelay_trace_event_t events[TT_TRACE_SIZE];
+    TTDelay_trace_header_t header;
+    for (int i = 0 ; i < TT_TRACE_SIZE + 10 ; i++)
+        TTDelay_trace(TT_TRACE_USER, TT_TRACE_NO_TASK, i);
+
+    // the oldest slot is the next one written, it is left out
+    TEST_ASSERT_EQUAL(TT_TRACE_SIZE - 1, TTDelay_trace_read(&header, events, TT_TRACE_SIZE));
+    TEST_ASSERT_EQUAL(11, header.uiLost);
+    TEST_ASSERT_EQUAL(11, events[0].uiArg);
+    TEST_ASSERT_EQUAL(TT_TRACE_SIZE + 9, events[TT_TRACE_SIZE - 2].uiArg);
+
+    TEST_ASSERT_EQUAL(2, TTDelay_trace_read(&header, events, 2));
+    TEST_ASSERT_EQUAL(TT_TRACE_SIZE + 8, events[0].uiArg);
+
+    TTDelay_trace_clear();
+    TEST_ASSERT_EQUAL(0, TTDelay_trace_read(&header, events, TT_TRACE_SIZE));
+}
+
 void heavy_compute_thread_1(void *in, void* out){
     *(int*)out = *(int*)in + 1;
     TTDelay_from_last(10000);
@@ -521,6 +1110,243 @@ void heavy_compute_thread_3(void *in, void* out){
     TTDelay_from_last(10000);
 }
 
+int co_flag;
+
+// counts the steps in *out: 1 start, 2 after yield, 3 after wait, 4 after wait until
+void co_sequence(void* in, void* out){
+    TT_CO_BEGIN();
+    *(int*)out = 1;
+    TT_CO_YIELD();
+    *(int*)out = 2;
+    TT_CO_WAIT(DELAY_TIME);
+    *(int*)out = 3;
+    TT_CO_WAIT_UNTIL(co_flag, 5);
+    *(int*)out = 4;
+    TT_CO_END();
+}
+
+void test_coroutine_resumes_after_yield_and_waits(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(co_sequence, NULL, &output_value, 5);
+
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+    // the yield leaves the task due
+    GetSysTick_ExpectAndReturn(1);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    TEST_ASSERT_EQUAL(1 + DELAY_TIME, TTDelay_get_next_schedule_time(0));
+
+    GetSysTick_ExpectAndReturn(DELAY_TIME);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    GetSysTick_ExpectAndReturn(1 + DELAY_TIME);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(3, output_value);
+    TEST_ASSERT_EQUAL(1 + DELAY_TIME + 5, TTDelay_get_next_schedule_time(0));
+
+    GetSysTick_ExpectAndReturn(1 + DELAY_TIME + 5);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(3, output_value);
+    co_flag = 1;
+    GetSysTick_ExpectAndReturn(1 + DELAY_TIME + 10);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(4, output_value);
+    // after the end the next run starts over
+    GetSysTick_ExpectAndReturn(1 + DELAY_TIME + 11);
+    output_value = 0;
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+    co_flag = 0;
+}
+
+/* *****************************************************************************
+ *  THIS SECTION TESTS EVENT TRIGGERED TASKS
+ * *****************************************************************************/
+int event_timeout;
+
+void event_waiter(void* in, void* out){
+    *((int*)out) = TTDelay_was_notified() ? 2 : 1;
+    TTDelay_wait_event(event_timeout);
+}
+
+void test_notify_makes_waiting_task_due(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    event_timeout = TT_WAIT_FOREVER;
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(event_waiter, NULL, &output_value, 5);
+
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+    output_value = 0;
+    GetSysTick_ExpectAndReturn(1000);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(0, output_value);
+
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_notify(0));
+    TTDelay_notify(0);
+    GetSysTick_ExpectAndReturn(1001);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    // both notifications were taken by one run
+    output_value = 0;
+    GetSysTick_ExpectAndReturn(1002);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(0, output_value);
+
+    // a task suspended by the user ignores events
+    TTDelay_notify(0);
+    GetSysTick_ExpectAndReturn(1003);
+    TTDelay_run();
+    TTDelay_suspend_task(0);
+    TTDelay_notify(0);
+    output_value = 0;
+    GetSysTick_ExpectAndReturn(1004);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(0, output_value);
+}
+
+void test_notify_rejects_index_out_of_range(){
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_notify(-1));
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_notify(TT_TASK_COUNT_MAX));
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_IDLE_FOREVER, TTDelay_get_remaining_idle_time());
+}
+
+void test_wait_event_with_timeout(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    event_timeout = DELAY_TIME;
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(event_waiter, NULL, &output_value, 5);
+
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+    TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_next_schedule_time(0));
+    GetSysTick_ExpectAndReturn(DELAY_TIME);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+
+    // notified before the timeout
+    output_value = 0;
+    TTDelay_notify(0);
+    GetSysTick_ExpectAndReturn(DELAY_TIME + 1);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    TEST_ASSERT_EQUAL(2 * DELAY_TIME + 1, TTDelay_get_next_schedule_time(0));
+}
+
+/* *****************************************************************************
+ *  THIS SECTION TESTS COMMANDS FROM OTHER THREADS
+ * *****************************************************************************/
+void test_post_command_reschedules_and_retunes_task(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_periodic(delay_periodic_increase, NULL, &output_value, 5, 1000);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+
+    // applied by the next search for due tasks, in the order posted
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 1000));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 10));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_PERIOD, 50));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_PRIORITY, 2));
+    GetSysTick_ExpectAndReturn(100);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+    TEST_ASSERT_EQUAL(110, TTDelay_get_next_schedule_time(0));
+    TEST_ASSERT_EQUAL(50, TTDelay_get_task(0)->uiPeriod);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task(0)->uiInitialPriority);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task(0)->uiCurrentPriority);
+
+    GetSysTick_ExpectAndReturn(110);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+    TEST_ASSERT_EQUAL(160, TTDelay_get_next_schedule_time(0));
+
+    // a full queue refuses commands until it is drained
+    for (int i = 0 ; i < TT_COMMAND_QUEUE_SIZE ; i++)
+        TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 0));
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 0));
+    GetSysTick_ExpectAndReturn(115);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_remaining_idle_time());
+    GetSysTick_ExpectAndReturn(120);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(3, output_value);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 0));
+}
+
+/* *****************************************************************************
+ *  THIS SECTION TESTS THE SCHEDULE TABLE
+ * *****************************************************************************/
+void test_table_generate_orders_hyperperiod_by_offset_and_priority(){
+    TTDelay_slot_t slot[8];
+    TT_TIMER_TYPE  hyperperiod;
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_periodic(delay_periodic_increase, NULL, &output_value, 5, 2);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_periodic(delay_periodic_increase, NULL, &delay_test_var, 3, 3);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delay_periodic_increase, NULL, &led_value, 1);
+
+    TEST_ASSERT_EQUAL(-1, TTDelay_table_generate(slot, 4, &hyperperiod));
+    TEST_ASSERT_EQUAL(5, TTDelay_table_generate(slot, 8, &hyperperiod));
+    TEST_ASSERT_EQUAL(6, hyperperiod);
+    const TT_TIMER_TYPE offset[] = { 0, 0, 2, 3, 4 };
+    const int           task[]   = { 1, 0, 0, 1, 0 };
+    for (int i = 0 ; i < 5 ; i++){
+        TEST_ASSERT_EQUAL(offset[i], slot[i].uiOffset);
+        TEST_ASSERT_EQUAL(task[i], slot[i].uiTask);
+    }
+}
+
+void test_run_table_steps_through_slots(){
+    static const TTDelay_slot_t slot[] = { { 0, 1 }, { 0, 0 }, { 2, 0 }, { 3, 1 }, { 4, 0 } };
+    TTDelay_table_t table;
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delay_periodic_increase, NULL, &output_value, 5);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(delay_periodic_increase, NULL, &delay_test_var, 3);
+
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_table_start(&table, slot, 5, 4));
+    GetSysTick_ExpectAndReturn(100);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_table_start(&table, slot, 5, 6));
+    GetSysTick_ExpectAndReturn(100);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run_table(&table));
+    TEST_ASSERT_EQUAL(0, output_value);
+    TEST_ASSERT_EQUAL(1, delay_test_var);
+    GetSysTick_ExpectAndReturn(100);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_table(&table));
+    TEST_ASSERT_EQUAL(1, output_value);
+    GetSysTick_ExpectAndReturn(101);
+    TTDelay_run_table(&table);
+    TEST_ASSERT_EQUAL(1, output_value);
+
+    // late: the slots at 102 and 103 are run one after the other
+    GetSysTick_ExpectAndReturn(103);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_run_table(&table));
+    GetSysTick_ExpectAndReturn(103);
+    TTDelay_run_table(&table);
+    TEST_ASSERT_EQUAL(2, output_value);
+    TEST_ASSERT_EQUAL(2, delay_test_var);
+    GetSysTick_ExpectAndReturn(104);
+    TTDelay_run_table(&table);
+    TEST_ASSERT_EQUAL(3, output_value);
+
+    // next hyperperiod
+    GetSysTick_ExpectAndReturn(105);
+    TTDelay_run_table(&table);
+    TEST_ASSERT_EQUAL(2, delay_test_var);
+    GetSysTick_ExpectAndReturn(106);
+    TTDelay_run_table(&table);
+    TEST_ASSERT_EQUAL(3, delay_test_var);
+}
+
 void test_cpu_usage_two_heavy_computing_tasks(){
     TEST_IGNORE_MESSAGE("Lost track on how this one worked");
     int a = 0;
@@ -561,4 +1387,63 @@ void test_cpu_usage_two_heavy_computing_tasks(){
     TEST_ASSERT_FLOAT_WITHIN(0.001, 0.000, TTDelay_get_task(2)->rCpuUsage);     //    0 / 4100
     TEST_ASSERT_FLOAT_WITHIN(0.002, 0.007, TTDelay_get_idle_time_percentage()); //   30 / 4100
     TEST_ASSERT_FLOAT_WITHIN(0.002, 0.017, TTDelay_get_ttsys_time_percentage());//   70 / 4100
-}
\ No newline at end of file
+}
+
+/* *****************************************************************************
+ *  THIS SECTION TESTS INDEPENDENT INSTANCES (FUNCTIONS ENDING IN _r)
+ * *****************************************************************************/
+TTDelay_t instance_a;
+TTDelay_t instance_b;
+
+void instance_from_now(void* in, void* out){
+    *((int*)out) += 1;
+    // must reschedule the task of the instance that runs it
+    TEST_ASSERT_EQUAL_PTR(in, TTDelay_get_current_instance());
+    TTDelay_from_now(DELAY_TIME);
+}
+
+void test_instances_do_not_share_tasks(){
+    int a = 0, b = 0;
+    TTDelay_reset_r(&instance_a);
+    TTDelay_reset_r(&instance_b);
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_r(&instance_a, instance_from_now, &instance_a, &a, 10));
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_r(&instance_b, instance_from_now, &instance_b, &b, 10));
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task_r(&instance_b, instance_from_now, &instance_b, &b, 20));
+
+    TEST_ASSERT_EQUAL(1, TTDelay_get_task_count_r(&instance_a));
+    TEST_ASSERT_EQUAL(2, TTDelay_get_task_count_r(&instance_b));
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task_count());
+}
+
+void test_instances_run_and_reschedule_independently(){
+    int a = 0, b = 0;
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    TTDelay_reset_r(&instance_a);
+    TTDelay_reset_r(&instance_b);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_r(&instance_a, instance_from_now, &instance_a, &a, 10);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task_r(&instance_b, instance_from_now, &instance_b, &b, 10);
+
+    GetSysTick_ExpectAndReturn(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_r(&instance_a));
+    TEST_ASSERT_EQUAL(1, a);
+    TEST_ASSERT_EQUAL(DELAY_TIME, TTDelay_get_next_schedule_time_r(&instance_a, 0));
+    // instance b has not run yet, its task is still due at 0
+    TEST_ASSERT_EQUAL(0, TTDelay_get_next_schedule_time_r(&instance_b, 0));
+
+    GetSysTick_ExpectAndReturn(DELAY_TIME / 2);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_run_r(&instance_b));
+    TEST_ASSERT_EQUAL(1, b);
+    TEST_ASSERT_EQUAL(DELAY_TIME / 2 + DELAY_TIME, TTDelay_get_next_schedule_time_r(&instance_b, 0));
+
+    GetSysTick_ExpectAndReturn(DELAY_TIME);
+    TTDelay_run_r(&instance_a);
+    GetSysTick_ExpectAndReturn(DELAY_TIME);
+    TTDelay_run_r(&instance_b);
+    TEST_ASSERT_EQUAL(2, a);
+    TEST_ASSERT_EQUAL(1, b);
+}
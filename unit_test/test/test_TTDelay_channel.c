@@ -0,0 +1,82 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "TTDelay_channel.h"
+#include "mock_timers.h"
+
+
+typedef struct sample_t {
+    int      value;
+    uint32_t time;
+} sample_t;
+
+sample_t          slots[4];
+TTDelay_channel_t channel;
+int               received;
+
+void setUp(void)
+{
+    TTDelay_reset();
+    TTDelay_channel_init(&channel, slots, sizeof(sample_t), 4);
+    received = 0;
+}
+
+void tearDown(void)
+{
+
+}
+
+void channel_consumer(void* in, void* out){
+    sample_t* sample;
+    while ((sample = TTDelay_channel_peek(&channel))){
+        received += sample->value;
+        TTDelay_channel_release(&channel);
+    }
+    TTDelay_wait_event(TT_WAIT_FOREVER);
+}
+
+void test_channel_init_needs_power_of_2(){
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_channel_init(&channel, slots, sizeof(sample_t), 3));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_channel_init(&channel, slots, sizeof(sample_t), 2));
+}
+
+void test_channel_slots_are_passed_in_place(){
+    sample_t* sample;
+    TEST_ASSERT_NULL(TTDelay_channel_peek(&channel));
+    for (int i = 0 ; i < 4 ; i++){
+        sample = TTDelay_channel_reserve(&channel);
+        TEST_ASSERT_EQUAL_PTR(&slots[i], sample);
+        sample->value = i;
+        TTDelay_channel_commit(&channel);
+    }
+    TEST_ASSERT_NULL(TTDelay_channel_reserve(&channel));
+    TEST_ASSERT_EQUAL(4, TTDelay_channel_count(&channel));
+
+    // oldest first, from the slot the producer wrote to
+    TEST_ASSERT_EQUAL_PTR(&slots[0], TTDelay_channel_peek(&channel));
+    TTDelay_channel_release(&channel);
+    TEST_ASSERT_EQUAL_PTR(&slots[0], TTDelay_channel_reserve(&channel));
+    sample = TTDelay_channel_peek(&channel);
+    TEST_ASSERT_EQUAL(1, sample->value);
+    TEST_ASSERT_EQUAL(3, TTDelay_channel_count(&channel));
+}
+
+void test_channel_commit_makes_consumer_due(){
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_create_task(channel_consumer, NULL, NULL, 5);
+    TTDelay_channel_bind(&channel, TTDelay_get_current_instance(), TTDelay_get_last_created());
+    GetSysTick_ExpectAndReturn(0);
+    TTDelay_run();
+    GetSysTick_ExpectAndReturn(100);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(0, received);
+
+    ((sample_t*)TTDelay_channel_reserve(&channel))->value = 5;
+    TTDelay_channel_commit(&channel);
+    ((sample_t*)TTDelay_channel_reserve(&channel))->value = 7;
+    TTDelay_channel_commit(&channel);
+    GetSysTick_ExpectAndReturn(101);
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(12, received);
+    TEST_ASSERT_EQUAL(0, TTDelay_channel_count(&channel));
+}
@@ -0,0 +1,57 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "TTDelay_fiber.h"
+#include "mock_timers.h"
+
+
+TTDelay_fiber_pool_t fibers;
+int                  steps;
+
+void setUp(void)
+{
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_IgnoreAndReturn(0);
+    TTDelay_reset();
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_fiber_pool_init(&fibers, 1, 0));
+    steps = 0;
+}
+
+void tearDown(void)
+{
+    TTDelay_fiber_pool_destroy(&fibers);
+}
+
+void fiber_counter(void* in, void* out){
+    for (int i = 0 ; i < *((int*)in) ; i++){
+        steps++;
+        TTDelay_fiber_sleep(0);
+    }
+}
+
+void test_fiber_returns_stack_when_it_ends(){
+    int count = 2;
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_fiber_create(&fibers, TTDelay_get_current_instance(), fiber_counter, &count, NULL, 5));
+    TEST_ASSERT_EQUAL(TT_ERROR_TOO_MANY_TASKS, TTDelay_fiber_create(&fibers, TTDelay_get_current_instance(), fiber_counter, &count, NULL, 5));
+    for (int i = 0 ; i < 3 ; i++)
+        TTDelay_run();
+    TEST_ASSERT_EQUAL(2, steps);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task_count());
+    TEST_ASSERT_EQUAL(1, fibers.iFreeCount);
+}
+
+// a fiber task deleted while it sleeps gives its stack back
+void test_deleted_fiber_task_returns_stack(){
+    int count = 100;
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_fiber_create(&fibers, TTDelay_get_current_instance(), fiber_counter, &count, NULL, 5));
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, steps);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_delete_task(TTDelay_get_last_created()));
+
+    count = 1;
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_fiber_create(&fibers, TTDelay_get_current_instance(), fiber_counter, &count, NULL, 5));
+    TTDelay_run();
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, steps);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task_count());
+    TEST_ASSERT_EQUAL(1, fibers.iFreeCount);
+}
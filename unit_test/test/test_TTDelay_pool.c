@@ -0,0 +1,206 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "TTDelay_pool.h"
+#include "mock_timers.h"
+#include <pthread.h>
+#include <time.h>
+
+
+TTDelay_pool_t  pool;
+pthread_mutex_t record_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  record_cond = PTHREAD_COND_INITIALIZER;
+int             gate_open[2];
+int             gates_started;
+int             started[TT_TASK_COUNT_MAX];
+int             started_count;
+int             task_id[] = { 0, 1, 2, 3, 4, 5 };
+TT_THREAD_LOCAL uint32_t test_pool_ticks;
+
+void setUp(void)
+{
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_IgnoreAndReturn(0);
+    TTDelay_reset();
+    gate_open[0]  = 0;
+    gate_open[1]  = 0;
+    gates_started = 0;
+    started_count = 0;
+}
+
+void tearDown(void)
+{
+
+}
+
+// holds its worker until the test opens the gate
+void gate_task(void* in, void* out){
+    int gate = *(int*)in;
+    pthread_mutex_lock(&record_lock);
+    gates_started++;
+    pthread_cond_broadcast(&record_cond);
+    while (!gate_open[gate])
+        pthread_cond_wait(&record_cond, &record_lock);
+    pthread_mutex_unlock(&record_lock);
+}
+
+void record_task(void* in, void* out){
+    pthread_mutex_lock(&record_lock);
+    started[started_count++] = *(int*)in;
+    pthread_cond_broadcast(&record_cond);
+    pthread_mutex_unlock(&record_lock);
+}
+
+// waits until the condition is true, gives up after 2s
+int wait_for(int* value, int expected){
+    struct timespec deadline;
+    int             result = 0;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 2;
+    pthread_mutex_lock(&record_lock);
+    while ((*value < expected) && !result)
+        result = pthread_cond_timedwait(&record_cond, &record_lock, &deadline);
+    result = *value;
+    pthread_mutex_unlock(&record_lock);
+    return result;
+}
+
+void open_gate(int gate){
+    pthread_mutex_lock(&record_lock);
+    gate_open[gate] = 1;
+    pthread_cond_broadcast(&record_cond);
+    pthread_mutex_unlock(&record_lock);
+}
+
+void test_pool_starts_waiting_tasks_in_priority_order(){
+    int expected[] = { 1, 2, 3, 4, 5 };
+
+    TTDelay_create_task(gate_task, &task_id[0], NULL, 0);
+    TTDelay_create_task(gate_task, &task_id[1], NULL, 0);
+    for (int i = 5 ; i >= 2 ; i--)
+        TTDelay_create_task(record_task, &task_id[i], NULL, i);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_pool_start(&pool, TTDelay_get_current_instance(), 2));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(2, wait_for(&gates_started, 2));
+
+    // dispatched later, but goes before the lower priority tasks still waiting
+    TTDelay_create_task(record_task, &task_id[1], NULL, 1);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+
+    // more due tasks than workers: the one free worker starts them one by one
+    open_gate(0);
+    TEST_ASSERT_EQUAL(5, wait_for(&started_count, 5));
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, started, 5);
+
+    open_gate(1);
+    TTDelay_pool_stop(&pool);
+}
+
+// collects the finished tasks until none is running anymore, gives up after 2s
+int pool_finish(void){
+    struct timespec delay = { 0, 1000000 };
+    int             result = TT_MORE_TASKS_SCHEDULED;
+    for (int i = 0 ; (i < 2000) && (result == TT_MORE_TASKS_SCHEDULED) ; i++){
+        nanosleep(&delay, 0);
+        result = TTDelay_pool_run(&pool);
+    }
+    return result;
+}
+
+// commands for a running task are applied after it ended, after its own rescheduling
+void test_pool_holds_commands_for_running_task(){
+    TTDelay_create_task_periodic(gate_task, &task_id[0], NULL, 4, 10);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_pool_start(&pool, TTDelay_get_current_instance(), 2));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(1, wait_for(&gates_started, 1));
+
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_FROM_NOW, 50));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_PRIORITY, 7));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_SUSPEND, 0));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+
+    open_gate(0);
+    TEST_ASSERT_EQUAL(TT_OK, pool_finish());
+    TTDelay_pool_stop(&pool);
+    TEST_ASSERT_EQUAL(50, TTDelay_get_next_schedule_time(0));
+    TEST_ASSERT_EQUAL(7, TTDelay_get_task(0)->uiCurrentPriority);
+    TEST_ASSERT_EQUAL(TT_TASK_SUSPENDED, TTDelay_get_task(0)->uiFlags & TT_TASK_SUSPENDED);
+
+    // a later resume wins over a held suspend
+    gate_open[0] = 0;
+    TTDelay_resume_task(0);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_pool_start(&pool, TTDelay_get_current_instance(), 2));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(2, wait_for(&gates_started, 2));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_SUSPEND, 0));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(0, TT_COMMAND_RESUME, 0));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    open_gate(0);
+    TEST_ASSERT_EQUAL(TT_OK, pool_finish());
+    TTDelay_pool_stop(&pool);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task(0)->uiFlags & TT_TASK_SUSPENDED);
+    TEST_ASSERT_EQUAL(10, TTDelay_get_next_schedule_time(0));
+}
+
+// holds its worker until the pool is stopping
+void stop_gate_task(void* in, void* out){
+    struct timespec delay = { 0, 1000000 };
+    int             stopping = 0;
+    pthread_mutex_lock(&record_lock);
+    gates_started++;
+    pthread_cond_broadcast(&record_cond);
+    pthread_mutex_unlock(&record_lock);
+    for (int i = 0 ; (i < 2000) && !stopping ; i++){
+        nanosleep(&delay, 0);
+        pthread_mutex_lock(&pool.lock);
+        stopping = pool.fStop;
+        pthread_mutex_unlock(&pool.lock);
+    }
+    TTDelay_from_now(1000);
+}
+
+// a task that was dispatched but never started is due again after the stop,
+// without a run in its statistics
+void test_pool_stop_puts_back_waiting_task(){
+    TTDelay_create_task(stop_gate_task, NULL, NULL, 1);
+    TTDelay_create_task_periodic(record_task, &task_id[1], NULL, 5, 10);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_pool_start(&pool, TTDelay_get_current_instance(), 1));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(1, wait_for(&gates_started, 1));
+    TTDelay_pool_stop(&pool);
+
+    TEST_ASSERT_EQUAL(0, started_count);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_task(1)->timeRunning);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_exec_histogram_r(TTDelay_get_current_instance(), 1)->uiSamples);
+    TEST_ASSERT_EQUAL(0, TTDelay_get_next_schedule_time(1));
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, started_count);
+    TEST_ASSERT_EQUAL(10, TTDelay_get_next_schedule_time(1));
+}
+
+// takes as many TT_POOL_TICK_FUNC ticks as its input says
+void busy_task(void* in, void* out){
+    test_pool_ticks += *(int*)in;
+}
+
+// the execute times measured by the workers end up in the task statistics
+void test_pool_collects_execute_time(){
+    int ticks[] = { 30, 7 };
+    TTDelay_create_task_periodic(busy_task, &ticks[0], NULL, 1, 10);
+    TTDelay_create_task_periodic(busy_task, &ticks[1], NULL, 2, 10);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_pool_start(&pool, TTDelay_get_current_instance(), 2));
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(TT_OK, pool_finish());
+
+    ticks[0] = 12;
+    GetSysTick_IgnoreAndReturn(10);
+    TEST_ASSERT_EQUAL(TT_MORE_TASKS_SCHEDULED, TTDelay_pool_run(&pool));
+    TEST_ASSERT_EQUAL(TT_OK, pool_finish());
+    TTDelay_pool_stop(&pool);
+
+    TEST_ASSERT_EQUAL(42, TTDelay_get_task(0)->timeRunning);
+    TEST_ASSERT_EQUAL(30, TTDelay_get_task(0)->uiLongestExecuteDuration);
+    TEST_ASSERT_EQUAL(14, TTDelay_get_task(1)->timeRunning);
+    TEST_ASSERT_EQUAL(7, TTDelay_get_task(1)->uiLongestExecuteDuration);
+    TEST_ASSERT_EQUAL(2, TTDelay_get_exec_histogram_r(TTDelay_get_current_instance(), 0)->uiSamples);
+    TEST_ASSERT_EQUAL(30, TTDelay_get_exec_histogram_r(TTDelay_get_current_instance(), 0)->uiMax);
+}
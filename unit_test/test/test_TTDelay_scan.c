@@ -0,0 +1,90 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "mock_timers.h"
+
+
+// built with TT_SCAN_MASK and TT_TASK_COUNT_MAX 64 (see project.yml), so the
+// SIMD loop of TTDelay_scan_kernel() runs. the scan16 and scan_avx2 options
+// build it with a 16 bit TT_TIMER_TYPE and with AVX2
+#define TIMER_BITS      (sizeof(TT_TIMER_TYPE) * 8)
+// the sign bit, the SIMD compares flip it
+#define NOW             ((TT_TIMER_TYPE)1 << (TIMER_BITS - 1))
+
+TTDelay_t* tt;
+
+void setUp(void)
+{
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_IgnoreAndReturn(0);
+    TTDelay_reset();
+    tt = TTDelay_get_current_instance();
+}
+
+void tearDown(void)
+{
+
+}
+
+void empty_task(void* in, void* out){
+}
+
+// next execute times on both sides of NOW and of the sign bit, some tasks
+// with a pending overflow or running
+int task_is_due(int i){
+    return ((i % 5) != 2) && ((i % 5) != 4) && ((i % 7) != 3) && ((i % 11) != 5);
+}
+
+void create_tasks(int count){
+    const TT_TIMER_TYPE next[5] = { NOW - 1, NOW, NOW + 1, 0, (TT_TIMER_TYPE)~0 };
+    for (int i = 0 ; i < count ; i++){
+        TEST_ASSERT_EQUAL(TT_OK, TTDelay_create_task(empty_task, NULL, NULL, (uint8_t)(100 - i)));
+        tt->hot.uiTimeNextExecute[i]     = next[i % 5];
+        tt->hot.uiNextExecuteOverflow[i] = (i % 7) == 3;
+        tt->hot.fRunning[i]              = (i % 11) == 5;
+    }
+}
+
+void check_due_mask(int count){
+    uint32_t           expected[2] = { 0, 0 };
+    TT_TASK_INDEX_TYPE list[TT_TASK_COUNT_MAX];
+    int                due = 0, highest = -1;
+    for (int i = 0 ; i < count ; i++){
+        if (!task_is_due(i))
+            continue;
+        expected[i / 32] |= (uint32_t)1 << (i % 32);
+        due++;
+        highest = i;
+    }
+    GetSysTick_IgnoreAndReturn(NOW);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_EQUAL_HEX32(expected[0], tt->due_mask[0]);
+    TEST_ASSERT_EQUAL_HEX32(expected[1], tt->due_mask[1]);
+    TEST_ASSERT_EQUAL(due, TTDelay_get_due_tasks_r(tt, list, TT_TASK_COUNT_MAX));
+    for (int i = 0 ; i < count ; i++)
+        TEST_ASSERT_EQUAL(task_is_due(i), TTDelay_is_due(i));
+    // the last task has the highest priority
+    TEST_ASSERT_EQUAL(highest, TTDelay_get_next_scheduled());
+}
+
+// two full words, all done by the SIMD loop
+void test_scan_mask_of_full_words(){
+    create_tasks(64);
+    check_due_mask(64);
+}
+
+// one word by the SIMD loop, the rest by the portable code
+void test_scan_mask_with_tail(){
+    create_tasks(45);
+    check_due_mask(45);
+}
+
+// nothing due before the sign bit is reached
+void test_scan_mask_before_time(){
+    create_tasks(64);
+    for (int i = 0 ; i < 64 ; i++)
+        tt->hot.uiTimeNextExecute[i] = NOW;
+    GetSysTick_IgnoreAndReturn(NOW - 1);
+    TTDelay_find_due_tasks();
+    TEST_ASSERT_EQUAL_HEX32(0, tt->due_mask[0]);
+    TEST_ASSERT_EQUAL_HEX32(0, tt->due_mask[1]);
+}
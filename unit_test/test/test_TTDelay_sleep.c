@@ -0,0 +1,102 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "TTDelay_sleep.h"
+#include "mock_timers.h"
+#include <pthread.h>
+#include <time.h>
+
+
+TTDelay_sleep_t sleeper;
+pthread_t       helper;
+pthread_mutex_t helper_lock = PTHREAD_MUTEX_INITIALIZER;
+pthread_cond_t  helper_cond = PTHREAD_COND_INITIALIZER;
+int             helper_done;
+int             output_value;
+
+void setUp(void)
+{
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    GetSysTick_IgnoreAndReturn(0);
+    TTDelay_reset();
+    TTDelay_sleep_init(&sleeper, TTDelay_get_current_instance());
+    helper_done  = 0;
+    output_value = 0;
+}
+
+void tearDown(void)
+{
+    TTDelay_sleep_destroy(&sleeper);
+}
+
+void event_waiter(void* in, void* out){
+    *((int*)out) = TTDelay_was_notified() ? 2 : 1;
+    TTDelay_wait_event(TT_WAIT_FOREVER);
+}
+
+uint64_t now_ms(void){
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+// notifies task 0 (arg NULL) or posts a resume command for it after 20 ms.
+// ends the sleep after 1 s if the wake hook did not, so a broken hook fails
+// the test instead of hanging it
+void* waker(void* arg){
+    struct timespec deadline;
+    struct timespec delay = { 0, 20000000 };
+    nanosleep(&delay, 0);
+    if (arg)
+        TTDelay_post_command(0, TT_COMMAND_RESUME, 0);
+    else
+        TTDelay_notify(0);
+
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += 1;
+    pthread_mutex_lock(&helper_lock);
+    while (!helper_done && !pthread_cond_timedwait(&helper_cond, &helper_lock, &deadline))
+        ;
+    if (!helper_done)
+        TTDelay_sleep_wakeup(&sleeper);
+    pthread_mutex_unlock(&helper_lock);
+    return 0;
+}
+
+void stop_waker(void){
+    pthread_mutex_lock(&helper_lock);
+    helper_done = 1;
+    pthread_cond_signal(&helper_cond);
+    pthread_mutex_unlock(&helper_lock);
+    pthread_join(helper, 0);
+}
+
+void test_notify_ends_sleep(){
+    uint64_t start;
+    TTDelay_create_task(event_waiter, NULL, &output_value, 5);
+
+    // runs the task once, then nothing is waiting for a time
+    start = now_ms();
+    pthread_create(&helper, 0, waker, NULL);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_sleep_run(&sleeper));
+    stop_waker();
+    TEST_ASSERT_LESS_THAN(500, now_ms() - start);
+    TEST_ASSERT_EQUAL(1, output_value);
+
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(2, output_value);
+}
+
+void test_command_ends_sleep(){
+    uint64_t start;
+    TTDelay_create_task(event_waiter, NULL, &output_value, 5);
+
+    start = now_ms();
+    pthread_create(&helper, 0, waker, &sleeper);
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_sleep_run(&sleeper));
+    stop_waker();
+    TEST_ASSERT_LESS_THAN(500, now_ms() - start);
+
+    output_value = 0;
+    TTDelay_run();
+    TEST_ASSERT_EQUAL(1, output_value);
+}
@@ -0,0 +1,89 @@
+#include "unity.h"
+#include "TTDelay.h"
+#include "mock_timers.h"
+
+
+// built with TT_STATIC_TASKS, the task table is TT_TEST_STATIC_TASKS in timers.h
+int static_id[3] = { 0, 1, 2 };
+int static_log[16];
+int static_count;
+
+// the periodic tasks are rescheduled afterwards. the logger is not and would
+// stay due, with TT_POLICY_EDF also with the earliest deadline
+void static_task(void* in, void* out){
+    ((int*)out)[static_count++] = *((int*)in);
+    if (*((int*)in) == TT_TASK_logger)
+        TTDelay_from_now(1000);
+}
+
+TT_STATIC_TASK_TABLE();
+
+// all are due at the start: highest priority first, with TT_POLICY_EDF the
+// earliest deadline (the period, the logger has none)
+#if TT_SCHEDULING_POLICY == TT_POLICY_EDF
+    #define STATIC_TASK_ORDER   { TT_TASK_logger, TT_TASK_filter, TT_TASK_control }
+#else
+    #define STATIC_TASK_ORDER   { TT_TASK_control, TT_TASK_filter, TT_TASK_logger }
+#endif
+
+void setUp(void)
+{
+    ReadResetCpuLoadTick_IgnoreAndReturn(0);
+    static_count = 0;
+}
+
+void tearDown(void)
+{
+
+}
+
+void run_tasks(int count, uint32_t time){
+    for (int i = 0 ; i < count ; i++){
+        GetSysTick_ExpectAndReturn(time);
+        TTDelay_run();
+    }
+}
+
+// has to run first: the default instance is set up by the compiler
+void test_static_tasks_are_due_at_startup(){
+    int expected[] = STATIC_TASK_ORDER;
+
+    TEST_ASSERT_EQUAL(3, TT_STATIC_TASK_COUNT);
+    TEST_ASSERT_EQUAL(3, TTDelay_get_task_count());
+    TEST_ASSERT_EQUAL(1, TT_TASK_control);
+    TEST_ASSERT_EQUAL(static_task, ttStaticTask[TT_TASK_filter].func);
+
+    // the periodic ones are rescheduled
+    run_tasks(3, 0);
+    TEST_ASSERT_EQUAL(3, static_count);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, static_log, 3);
+    TEST_ASSERT_EQUAL(100, TTDelay_get_next_schedule_time(TT_TASK_control));
+    TEST_ASSERT_EQUAL(50, TTDelay_get_next_schedule_time(TT_TASK_filter));
+}
+
+void test_static_tasks_are_set_up_again_by_reset(){
+    int expected[] = STATIC_TASK_ORDER;
+
+    TTDelay_reset();
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_delete_task(TT_TASK_logger));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_suspend_task(TT_TASK_control));
+    run_tasks(2, 10);
+    TEST_ASSERT_EQUAL(1, static_count);
+    TEST_ASSERT_EQUAL(TT_TASK_filter, static_log[0]);
+
+    // deleted and suspended tasks are back, all due
+    static_count = 0;
+    TTDelay_reset();
+    TEST_ASSERT_EQUAL(3, TTDelay_get_task_count());
+    run_tasks(3, 20);
+    TEST_ASSERT_EQUAL(3, static_count);
+    TEST_ASSERT_EQUAL_INT_ARRAY(expected, static_log, 3);
+}
+
+// period and priority are in ROM
+void test_static_tasks_reject_period_and_priority_commands(){
+    TTDelay_reset();
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_post_command(TT_TASK_filter, TT_COMMAND_PERIOD, 10));
+    TEST_ASSERT_EQUAL(TT_NOK, TTDelay_post_command(TT_TASK_filter, TT_COMMAND_PRIORITY, 1));
+    TEST_ASSERT_EQUAL(TT_OK, TTDelay_post_command(TT_TASK_filter, TT_COMMAND_FROM_NOW, 10));
+}
@@ -4,4 +4,17 @@
 uint32_t GetSysTick();
 uint16_t ReadResetCpuLoadTick();
 
+// TT_POOL_TICK_FUNC of test_TTDelay_pool.c (see project.yml), one counter per
+// worker, moved by the tasks running on it
+#ifdef TT_POOL_TICK_FUNC
+extern TT_THREAD_LOCAL uint32_t test_pool_ticks;
+#endif
+
+// task table of test_TTDelay_static.c, it is built with
+// TT_STATIC_TASKS=TT_TEST_STATIC_TASKS (see project.yml)
+#define TT_TEST_STATIC_TASKS(X) \
+    X(logger,  static_task, &static_id[0], static_log, 9, 0) \
+    X(control, static_task, &static_id[1], static_log, 2, 100) \
+    X(filter,  static_task, &static_id[2], static_log, 5, 50)
+
 #endif
\ No newline at end of file